@@ -0,0 +1,125 @@
+#pragma once
+#include "SimpleCU_EventCount.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 为任意 `pop() -> std::optional<T>` 的容器加上阻塞式取出.
+   *
+   * 取出方先自旋 `spin_cnt` 次, 仍为空才在 `Utils::EventCount` 上睡眠;
+   * 放入方只在确实有线程睡眠时才进入内核唤醒, 负载下的吞吐与直接使用容器基本一致.
+   *
+   * @tparam Container 被包装的容器, 其 `push` / `emplace` 可返回 `void` 或表示成功与否的 `bool`.
+   */
+  template<typename Container>
+  class Blocking {
+  private:
+    using ValType_ = typename decltype(std::declval<Container &>().pop())::value_type;
+
+    constexpr static std::size_t spin_cnt{128};
+
+    Container container_;
+    Utils::EventCount ec_{};
+
+    template<typename Result>
+    auto notify_after(Result &&res) -> Result {
+      if (res) {
+        ec_.notify_one();
+      }
+      return std::forward<Result>(res);
+    }
+
+    auto spin_pop() -> std::optional<ValType_> {
+      for (std::size_t i = 0; i < spin_cnt; i++) {
+        if (std::optional<ValType_> res{container_.pop()}; res.has_value()) {
+          return res;
+        }
+        Utils::cpu_relax();
+      }
+      return std::nullopt;
+    }
+
+  public:
+    template<typename... Args>
+    explicit Blocking(Args &&...args) : container_(std::forward<Args>(args)...) {
+    }
+
+    Blocking(const Blocking &) = delete;
+    auto operator=(const Blocking &) -> Blocking & = delete;
+    Blocking(Blocking &&) = delete;
+    auto operator=(Blocking &&) -> Blocking & = delete;
+
+    /** 供批量接口等直接访问, 绕过此处放入的元素不会唤醒等待者. */
+    auto get() -> Container & {
+      return container_;
+    }
+
+    template<typename... Args>
+    auto push(Args &&...args) -> decltype(container_.push(std::forward<Args>(args)...)) {
+      if constexpr (std::is_void_v<decltype(container_.push(std::forward<Args>(args)...))>) {
+        container_.push(std::forward<Args>(args)...);
+        ec_.notify_one();
+      } else {
+        return notify_after(container_.push(std::forward<Args>(args)...));
+      }
+    }
+
+    template<typename... Args>
+    auto emplace(Args &&...args) -> decltype(container_.emplace(std::forward<Args>(args)...)) {
+      if constexpr (std::is_void_v<decltype(container_.emplace(std::forward<Args>(args)...))>) {
+        container_.emplace(std::forward<Args>(args)...);
+        ec_.notify_one();
+      } else {
+        return notify_after(container_.emplace(std::forward<Args>(args)...));
+      }
+    }
+
+    /** 不阻塞. */
+    auto pop() -> std::optional<ValType_> {
+      return container_.pop();
+    }
+
+    auto wait_pop() -> ValType_ {
+      if (std::optional<ValType_> res{spin_pop()}; res.has_value()) {
+        return std::move(res.value());
+      }
+      while (true) {
+        auto key{ec_.prepare_wait()};
+        if (std::optional<ValType_> res{container_.pop()}; res.has_value()) {
+          ec_.cancel_wait();
+          return std::move(res.value());
+        }
+        ec_.wait(key);
+      }
+    }
+
+    /**
+     * @return 超时仍为空返回 `std::nullopt`.
+     */
+    template<typename Rep, typename Period>
+    auto try_pop_for(const std::chrono::duration<Rep, Period> &timeout) -> std::optional<ValType_> {
+      auto deadline{std::chrono::steady_clock::now() + timeout};
+      if (std::optional<ValType_> res{spin_pop()}; res.has_value()) {
+        return res;
+      }
+      while (true) {
+        auto key{ec_.prepare_wait()};
+        if (std::optional<ValType_> res{container_.pop()}; res.has_value()) {
+          ec_.cancel_wait();
+          return res;
+        }
+        if (!ec_.wait_until(key, deadline)) {
+          return container_.pop();
+        }
+      }
+    }
+
+    /** 唤醒所有等待者, 例如关闭前让其复查退出条件. */
+    void notify_all() {
+      ec_.notify_all();
+    }
+  };
+
+} // namespace SimpleCU
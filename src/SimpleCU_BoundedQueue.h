@@ -0,0 +1,214 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 定容量的 MPMC 环形队列 (Vyukov), 不为元素分配节点.
+   *
+   * 每个槽位带序号 `seq_`: 等于位置 `pos` 时可写入, 等于 `pos + 1` 时可读出, 读出后置为 `pos + capacity`.
+   * 生产者和消费者只在各自的 `tail_` / `head_` 上 CAS 认领位置, 认领后独占对应槽位.
+   *
+   * @tparam ValType 元素类型.
+   * @tparam Backoff CAS 失败后的退避策略.
+   */
+  template<typename ValType, typename Backoff = Utils::NoBackoff>
+  class BoundedQueue {
+  private:
+    struct Slot {
+      std::atomic<std::size_t> seq_;
+      alignas(ValType) std::byte storage_[sizeof(ValType)];
+
+      auto val() -> ValType * {
+        return std::launder(reinterpret_cast<ValType *>(storage_));
+      }
+    };
+
+    using diff_t_ = std::make_signed_t<std::size_t>;
+
+    const std::size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    Utils::Aligned<std::atomic<std::size_t>> tail_{};
+    Utils::Aligned<std::atomic<std::size_t>> head_{};
+
+    auto slot_at(std::size_t pos) -> Slot & {
+      return slots_[pos & mask_];
+    }
+
+    /**
+     * 认领从 `pos_` 开始至多 `max_cnt` 个连续位置, 要求每个槽位的序号都等于 `pos + i + Lag`.
+     * 生产者 `Lag` 为 0, 消费者为 1. 返回认领的起点和数量, 数量为 0 表示已满 / 已空.
+     */
+    template<std::size_t Lag>
+    auto claim(Utils::Aligned<std::atomic<std::size_t>> &pos_, std::size_t max_cnt)
+        -> std::pair<std::size_t, std::size_t> {
+      std::size_t pos{pos_.load(std::memory_order_relaxed)};
+      Backoff backoff{};
+      while (true) {
+        std::size_t cnt{};
+        while (cnt < max_cnt) {
+          std::size_t seq{slot_at(pos + cnt).seq_.load(std::memory_order_acquire)};
+          diff_t_ diff{static_cast<diff_t_>(seq - (pos + cnt + Lag))};
+          if (diff != 0) {
+            if (cnt == 0 && diff > 0) { // 其他线程已越过 `pos`, 重新读取
+              cnt = std::numeric_limits<std::size_t>::max();
+            }
+            break;
+          }
+          cnt++;
+        }
+        if (cnt == std::numeric_limits<std::size_t>::max()) {
+          pos = pos_.load(std::memory_order_relaxed);
+          continue;
+        }
+        if (cnt == 0) {
+          return {pos, 0};
+        }
+        if (pos_.compare_exchange_weak(pos, pos + cnt, std::memory_order_relaxed)) {
+          return {pos, cnt};
+        }
+        backoff();
+      }
+    }
+
+  public:
+    /**
+     * @param capacity 向上取整为 2 的幂.
+     */
+    explicit BoundedQueue(std::size_t capacity)
+        : mask_{std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1}, slots_{std::make_unique<Slot[]>(mask_ + 1)} {
+      for (std::size_t i = 0; i <= mask_; i++) {
+        slots_[i].seq_.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    auto operator=(const BoundedQueue &) -> BoundedQueue & = delete;
+    BoundedQueue(BoundedQueue &&) = delete;
+    auto operator=(BoundedQueue &&) -> BoundedQueue & = delete;
+
+    ~BoundedQueue() {
+      std::size_t tail{tail_.load(std::memory_order_relaxed)};
+      for (std::size_t pos = head_.load(std::memory_order_relaxed); pos != tail; pos++) {
+        std::destroy_at(slot_at(pos).val());
+      }
+    }
+
+    auto capacity() const -> std::size_t {
+      return mask_ + 1;
+    }
+
+    /**
+     * `head_` 处的槽位尚未发布. 只是某一时刻的快照, 不认领位置, 供等待方在睡眠前复查.
+     * `head_` 已被其他消费者推进时返回 `false`.
+     */
+    auto empty() -> bool {
+      std::size_t pos{head_.load(std::memory_order_relaxed)};
+      return static_cast<diff_t_>(slot_at(pos).seq_.load(std::memory_order_acquire) - (pos + 1)) < 0;
+    }
+
+    /**
+     * `tail_` 处的槽位尚未被读出, 与 `empty` 相同只是快照.
+     */
+    auto full() -> bool {
+      std::size_t pos{tail_.load(std::memory_order_relaxed)};
+      return static_cast<diff_t_>(slot_at(pos).seq_.load(std::memory_order_acquire) - pos) < 0;
+    }
+
+    /**
+     * @return 队列满时返回 `false`, 参数不被消耗.
+     */
+    template<typename... Args>
+    auto try_emplace(Args &&...args) -> bool {
+      auto [pos, cnt]{claim<0>(tail_, 1)};
+      if (cnt == 0) {
+        return false;
+      }
+      Slot &slot{slot_at(pos)};
+      std::construct_at(slot.val(), std::forward<Args>(args)...);
+      slot.seq_.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    auto try_push(const ValType &val) -> bool {
+      return try_emplace(val);
+    }
+
+    auto try_push(ValType &&val) -> bool {
+      return try_emplace(std::move(val));
+    }
+
+    auto try_pop() -> std::optional<ValType> {
+      auto [pos, cnt]{claim<1>(head_, 1)};
+      if (cnt == 0) {
+        return std::nullopt;
+      }
+      Slot &slot{slot_at(pos)};
+      std::optional<ValType> ret{std::move(*slot.val())};
+      std::destroy_at(slot.val());
+      slot.seq_.store(pos + mask_ + 1, std::memory_order_release);
+      return ret;
+    }
+
+    /**
+     * 满时等待直到写入. 等待的是消费者而不是 CAS 竞争, 自旋到上限后让出时间片.
+     */
+    void push(const ValType &val) {
+      Utils::ExpBackoff<1, 64, true> backoff{};
+      while (!try_push(val)) {
+        backoff();
+      }
+    }
+
+    void push(ValType &&val) {
+      Utils::ExpBackoff<1, 64, true> backoff{};
+      while (!try_push(std::move(val))) {
+        backoff();
+      }
+    }
+
+    auto pop() -> std::optional<ValType> {
+      return try_pop();
+    }
+
+    /**
+     * 一次 CAS 认领一段连续的空闲位置, 写入 `[first, last)` 的前缀.
+     * @return 写入的元素个数, 队列满时可能少于 `last - first`.
+     */
+    template<typename ForwardIt>
+    auto try_push_bulk(ForwardIt first, ForwardIt last) -> std::size_t {
+      std::size_t want{static_cast<std::size_t>(std::distance(first, last))};
+      if (want == 0) {
+        return 0;
+      }
+      auto [pos, cnt]{claim<0>(tail_, std::min(want, capacity()))};
+      for (std::size_t i = 0; i < cnt; i++, ++first) {
+        Slot &slot{slot_at(pos + i)};
+        std::construct_at(slot.val(), *first);
+        slot.seq_.store(pos + i + 1, std::memory_order_release);
+      }
+      return cnt;
+    }
+
+    /**
+     * 一次 CAS 认领一段连续的已发布元素, 依次写入 `out`.
+     * @return 读出的元素个数.
+     */
+    template<typename OutputIt>
+    auto try_pop_bulk(OutputIt out, std::size_t max_cnt) -> std::size_t {
+      if (max_cnt == 0) {
+        return 0;
+      }
+      auto [pos, cnt]{claim<1>(head_, std::min(max_cnt, capacity()))};
+      for (std::size_t i = 0; i < cnt; i++) {
+        Slot &slot{slot_at(pos + i)};
+        *out++ = std::move(*slot.val());
+        std::destroy_at(slot.val());
+        slot.seq_.store(pos + i + mask_ + 1, std::memory_order_release);
+      }
+      return cnt;
+    }
+  };
+
+} // namespace SimpleCU
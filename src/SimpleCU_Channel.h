@@ -0,0 +1,290 @@
+#pragma once
+#include "SimpleCU_BoundedQueue.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 在调用方线程上直接执行. 被恢复的协程在唤醒方的调用栈中运行, 适合单线程或测试.
+   */
+  struct InlineExecutor {
+    template<typename Fn>
+    void submit(Fn &&fn) {
+      std::forward<Fn>(fn)();
+    }
+  };
+
+  /**
+   * @brief 供协程使用的定容量 MPMC 通道: `co_await ch.send(x)` / `co_await ch.recv()`.
+   *
+   * 数据存放在通道自己的 `BoundedQueue` 中. 缓冲区不满 / 不空时 `send` / `recv` 不挂起,
+   * 只有一次 CAS 认领位置, 加上一次 fence 和两次 load 检查对侧是否有等待者, 不加锁也不分配内存.
+   *
+   * 满 / 空时 awaiter 本身 (位于协程帧中) 作为节点压入对应的无锁等待栈, 之后复查缓冲区.
+   * 让缓冲区从空变为非空 (或从满变为不满) 的一方在 fence 之后检查等待栈, 二者至少一方能看到对方, 不会丢失唤醒.
+   * 服务等待者时一次取走整个栈, 节点只被取走它的一方访问, 没有 ABA, 也不会访问已恢复的协程帧:
+   * - 接收方: 从缓冲区取出元素放入其 awaiter, 再把恢复交给 `Executor`;
+   * - 发送方: 把其 awaiter 中的值放入缓冲区, 再恢复.
+   * 缓冲区耗尽时把剩余的节点压回并再次复查. 只有挂起的一侧经过 `Executor`, 分配与否取决于 `Executor`.
+   *
+   * 析构时不应有挂起的协程.
+   *
+   * @tparam ValType 元素类型, 须可移动构造.
+   * @tparam Executor 提供 `submit(fn)`, 例如 `ThreadPool`, `InlineExecutor`.
+   */
+  template<typename ValType, typename Executor>
+    requires std::move_constructible<ValType>
+  class Channel {
+  public:
+    class SendAwaiter;
+    class RecvAwaiter;
+
+  private:
+    BoundedQueue<ValType> buffer_;
+    Executor *executor_;
+    Utils::Aligned<std::atomic<SendAwaiter *>> send_waiters_{};
+    Utils::Aligned<std::atomic<RecvAwaiter *>> recv_waiters_{};
+
+    template<typename Awaiter>
+    static void push_chain(std::atomic<Awaiter *> &head, Awaiter *first) {
+      Awaiter *last{first};
+      while (last->next_) {
+        last = last->next_;
+      }
+      Awaiter *old{head.load(std::memory_order_relaxed)};
+      do {
+        last->next_ = old;
+      } while (!head.compare_exchange_weak(old, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * 取走整个等待栈并反转, 先挂起的先被服务.
+     */
+    template<typename Awaiter>
+    static auto take_chain(std::atomic<Awaiter *> &head) -> Awaiter * {
+      Awaiter *chain{head.exchange(nullptr, std::memory_order_acquire)};
+      Awaiter *reversed{};
+      while (chain) {
+        reversed = std::exchange(chain, std::exchange(chain->next_, reversed));
+      }
+      return reversed;
+    }
+
+    void resume(std::coroutine_handle<> handle) {
+      executor_->submit([handle]() { handle.resume(); });
+    }
+
+    /**
+     * 把缓冲区中的元素交给等待的接收方.
+     *
+     * @return 是否交出了元素, 交出后缓冲区有了空位.
+     */
+    auto serve_recv() -> bool {
+      bool served{};
+      while (RecvAwaiter *chain{take_chain(recv_waiters_)}) {
+        while (chain) {
+          std::optional<ValType> val{buffer_.try_pop()};
+          if (!val.has_value()) {
+            break;
+          }
+          RecvAwaiter *waiter{std::exchange(chain, chain->next_)};
+          waiter->val_.emplace(std::move(val.value()));
+          resume(waiter->handle_);
+          served = true;
+        }
+        if (!chain) {
+          break;
+        }
+        push_chain(recv_waiters_, chain);
+        // 持有等待栈期间发布的元素的发送方看到的是空栈, 压回后须复查
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (buffer_.empty()) {
+          break;
+        }
+      }
+      return served;
+    }
+
+    /**
+     * 把等待的发送方的值放入缓冲区.
+     *
+     * @return 是否放入了元素.
+     */
+    auto serve_send() -> bool {
+      bool served{};
+      while (SendAwaiter *chain{take_chain(send_waiters_)}) {
+        while (chain && buffer_.try_push(std::move(chain->val_))) {
+          resume(std::exchange(chain, chain->next_)->handle_);
+          served = true;
+        }
+        if (!chain) {
+          break;
+        }
+        push_chain(send_waiters_, chain);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (buffer_.full()) {
+          break;
+        }
+      }
+      return served;
+    }
+
+    /**
+     * 缓冲区状态改变之后调用. 服务一侧会改变另一侧的条件, 循环直到两侧都没有进展.
+     */
+    void notify() {
+      while (true) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool served{};
+        if (recv_waiters_.load(std::memory_order_relaxed)) {
+          served |= serve_recv();
+        }
+        if (send_waiters_.load(std::memory_order_relaxed)) {
+          served |= serve_send();
+        }
+        if (!served) {
+          return;
+        }
+      }
+    }
+
+  public:
+    class SendAwaiter {
+    private:
+      friend class Channel;
+
+      Channel *ch_;
+      SendAwaiter *next_{};
+      std::coroutine_handle<> handle_{};
+      ValType val_;
+
+      SendAwaiter(Channel *ch, ValType &&val) : ch_{ch}, val_{std::move(val)} {
+      }
+
+    public:
+      SendAwaiter(const SendAwaiter &) = delete;
+      auto operator=(const SendAwaiter &) -> SendAwaiter & = delete;
+      SendAwaiter(SendAwaiter &&) = delete;
+      auto operator=(SendAwaiter &&) -> SendAwaiter & = delete;
+
+      auto await_ready() -> bool {
+        return ch_->try_send(std::move(val_));
+      }
+
+      /**
+       * 压入等待栈之后可能立即被其他线程 (或本线程的 `serve_send`) 恢复, 之后不再访问 `this`.
+       */
+      void await_suspend(std::coroutine_handle<> handle) {
+        Channel *ch{ch_};
+        handle_ = handle;
+        ch->push_chain(ch->send_waiters_, this);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ch->buffer_.full()) {
+          ch->notify();
+        }
+      }
+
+      void await_resume() {
+      }
+    };
+
+    class RecvAwaiter {
+    private:
+      friend class Channel;
+
+      Channel *ch_;
+      RecvAwaiter *next_{};
+      std::coroutine_handle<> handle_{};
+      std::optional<ValType> val_{};
+
+      explicit RecvAwaiter(Channel *ch) : ch_{ch} {
+      }
+
+    public:
+      RecvAwaiter(const RecvAwaiter &) = delete;
+      auto operator=(const RecvAwaiter &) -> RecvAwaiter & = delete;
+      RecvAwaiter(RecvAwaiter &&) = delete;
+      auto operator=(RecvAwaiter &&) -> RecvAwaiter & = delete;
+
+      auto await_ready() -> bool {
+        val_ = ch_->try_recv();
+        return val_.has_value();
+      }
+
+      void await_suspend(std::coroutine_handle<> handle) {
+        Channel *ch{ch_};
+        handle_ = handle;
+        ch->push_chain(ch->recv_waiters_, this);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ch->buffer_.empty()) {
+          ch->notify();
+        }
+      }
+
+      auto await_resume() -> ValType {
+        return std::move(val_.value());
+      }
+    };
+
+    /**
+     * @param capacity 缓冲区容量, 向上取整为 2 的幂.
+     * @param executor 挂起的协程在其上恢复, 生存期应长于通道.
+     */
+    Channel(std::size_t capacity, Executor &executor) : buffer_{capacity}, executor_{&executor} {
+    }
+
+    Channel(const Channel &) = delete;
+    auto operator=(const Channel &) -> Channel & = delete;
+    Channel(Channel &&) = delete;
+    auto operator=(Channel &&) -> Channel & = delete;
+
+    auto capacity() const -> std::size_t {
+      return buffer_.capacity();
+    }
+
+    /**
+     * 缓冲区满时挂起, 直到值被放入缓冲区.
+     */
+    auto send(ValType val) -> SendAwaiter {
+      return SendAwaiter{this, std::move(val)};
+    }
+
+    /**
+     * 缓冲区空时挂起, 恢复时已取得元素.
+     */
+    auto recv() -> RecvAwaiter {
+      return RecvAwaiter{this};
+    }
+
+    /**
+     * 不挂起, 可在协程外使用.
+     *
+     * @return 缓冲区满时返回 `false`, 参数不被消耗.
+     */
+    auto try_send(ValType &&val) -> bool {
+      if (!buffer_.try_push(std::move(val))) {
+        return false;
+      }
+      notify();
+      return true;
+    }
+
+    auto try_send(const ValType &val) -> bool {
+      if (!buffer_.try_push(val)) {
+        return false;
+      }
+      notify();
+      return true;
+    }
+
+    auto try_recv() -> std::optional<ValType> {
+      std::optional<ValType> ret{buffer_.try_pop()};
+      if (ret.has_value()) {
+        notify();
+      }
+      return ret;
+    }
+  };
+
+} // namespace SimpleCU
@@ -0,0 +1,159 @@
+#pragma once
+#include "SimpleCU_Reclaim.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief Chase-Lev 工作窃取双端队列 (Lê 等人的 C11 内存序版本).
+   *
+   * 所有者在 `bottom_` 一端 `push` / `take`, 不与其他线程竞争, 只有取最后一个元素时才和窃取者 CAS `top_`;
+   * 窃取者在 `top_` 一端 `steal`, 彼此以 CAS `top_` 竞争.
+   *
+   * 环形数组满时由所有者扩容为两倍, 旧数组可能仍被窃取者读取, 交给 `Reclaimer` retire.
+   * 窃取者读取数组与元素期间位于 `Reclaimer` 的读侧保护中.
+   *
+   * 元素被窃取者以原子方式读取, 因此要求可平凡复制, 通常是指针.
+   *
+   * @tparam ValType 元素类型.
+   * @tparam Reclaimer 旧数组的回收策略, 默认 `Reclaim::QSBRPolicy`, 其 `ThreadCnt` 为窃取者数量上限.
+   */
+  template<typename ValType, typename Reclaimer = Reclaim::QSBRPolicy<>>
+    requires std::is_trivially_copyable_v<ValType>
+  class ChaseLevDeque {
+  private:
+    using idx_t_ = std::int64_t;
+
+    struct Array {
+      const idx_t_ mask_;
+      std::unique_ptr<std::atomic<ValType>[]> slots_;
+
+      explicit Array(idx_t_ capacity)
+          : mask_{capacity - 1}, slots_{std::make_unique<std::atomic<ValType>[]>(static_cast<std::size_t>(capacity))} {
+      }
+
+      auto capacity() const -> idx_t_ {
+        return mask_ + 1;
+      }
+
+      auto get(idx_t_ idx) const -> ValType {
+        return slots_[idx & mask_].load(std::memory_order_relaxed);
+      }
+
+      void put(idx_t_ idx, ValType val) {
+        slots_[idx & mask_].store(val, std::memory_order_relaxed);
+      }
+    };
+
+    /**
+     * 旧数组逐个 retire, 不成链.
+     */
+    struct NodeOps {
+      static auto next(Array *) -> Array * {
+        return nullptr;
+      }
+
+      void destroy(Array *arr) {
+        delete arr;
+      }
+    };
+
+    using Domain_ = typename Reclaimer::template Domain<Array, NodeOps>;
+
+    Utils::Aligned<std::atomic<idx_t_>> top_{};
+    Utils::Aligned<std::atomic<idx_t_>> bottom_{};
+    Utils::Aligned<std::atomic<Array *>> array_{};
+    Domain_ domain_;
+
+    auto grow(Array *old, idx_t_ top, idx_t_ bottom) -> Array * {
+      Array *arr{new Array{old->capacity() * 2}};
+      for (idx_t_ i = top; i < bottom; i++) {
+        arr->put(i, old->get(i));
+      }
+      array_.store(arr, std::memory_order_release);
+      domain_.retire(old, old);
+      return arr;
+    }
+
+  public:
+    /**
+     * @param capacity 初始容量, 向上取整为 2 的幂.
+     */
+    explicit ChaseLevDeque(std::size_t capacity = 256) : domain_{NodeOps{}} {
+      array_.store(new Array{static_cast<idx_t_>(std::bit_ceil(std::max<std::size_t>(capacity, 2)))},
+                   std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque &) = delete;
+    auto operator=(const ChaseLevDeque &) -> ChaseLevDeque & = delete;
+    ChaseLevDeque(ChaseLevDeque &&) = delete;
+    auto operator=(ChaseLevDeque &&) -> ChaseLevDeque & = delete;
+
+    /**
+     * 未取出的元素不做处理, 元素持有资源时由调用方先取空.
+     */
+    ~ChaseLevDeque() {
+      delete array_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 仅所有者调用.
+     */
+    void push(ValType val) {
+      idx_t_ bottom{bottom_.load(std::memory_order_relaxed)};
+      idx_t_ top{top_.load(std::memory_order_acquire)};
+      Array *arr{array_.load(std::memory_order_relaxed)};
+      if (bottom - top > arr->mask_) {
+        arr = grow(arr, top, bottom);
+      }
+      arr->put(bottom, val);
+      bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    /**
+     * 仅所有者调用, 从 `bottom_` 一端取出最近放入的元素.
+     * 对 `bottom_` 的写都是 release, 窃取者无论读到哪一次写, 都能看到此前放入的元素.
+     */
+    auto take() -> std::optional<ValType> {
+      idx_t_ bottom{bottom_.load(std::memory_order_relaxed) - 1};
+      Array *arr{array_.load(std::memory_order_relaxed)};
+      bottom_.store(bottom, std::memory_order_release);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      idx_t_ top{top_.load(std::memory_order_relaxed)};
+      if (top > bottom) {
+        bottom_.store(bottom + 1, std::memory_order_release);
+        return std::nullopt;
+      }
+      ValType val{arr->get(bottom)};
+      if (top == bottom) { // 最后一个元素, 与窃取者竞争
+        bool won{top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)};
+        bottom_.store(bottom + 1, std::memory_order_release);
+        if (!won) {
+          return std::nullopt;
+        }
+      }
+      return val;
+    }
+
+    /**
+     * 任意线程调用, 从 `top_` 一端取出最早放入的元素. 与其他线程竞争失败也返回 `std::nullopt`.
+     */
+    auto steal() -> std::optional<ValType> {
+      auto guard{domain_.guard()};
+      idx_t_ top{top_.load(std::memory_order_acquire)};
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      idx_t_ bottom{bottom_.load(std::memory_order_acquire)};
+      if (top >= bottom) {
+        return std::nullopt;
+      }
+      Array *arr{guard.protect(0, array_)};
+      ValType val{arr->get(top)};
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return std::nullopt;
+      }
+      return val;
+    }
+  };
+
+} // namespace SimpleCU
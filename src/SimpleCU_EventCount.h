@@ -0,0 +1,157 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define SIMPLECU_HAS_FUTEX 1
+#else
+#define SIMPLECU_HAS_FUTEX 0
+#endif
+
+namespace SimpleCU::Utils {
+
+  /**
+   * @brief Event Count, 把 "条件不满足就睡眠" 变成无锁容器可用的等待原语.
+   *
+   * 等待方:
+   * @code
+   * auto key{ec.prepare_wait()};
+   * if (条件满足) { ec.cancel_wait(); return; }
+   * ec.wait(key);
+   * @endcode
+   * 通知方先使条件满足, 再 `notify_*`. `prepare_wait` 与 `notify_*` 中的 seq_cst 保证:
+   * 要么等待方复查条件时已能看到修改, 要么通知方能看到等待者并推进 epoch, 不会丢失唤醒.
+   * 没有等待者时通知只有一次 load, 不进入内核.
+   *
+   * `Shared` 时使用非 private 的 futex, 对象可以放在进程间共享的内存中, 由各进程共同等待 / 通知.
+   * 没有 futex 的平台不支持 `Shared`.
+   *
+   * @tparam Shared 是否跨进程.
+   */
+  template<bool Shared = false>
+  class BasicEventCount {
+  private:
+    Aligned<std::atomic<std::uint32_t>> epoch_{};
+    Aligned<std::atomic<std::uint32_t>> waiters_{};
+
+#if SIMPLECU_HAS_FUTEX
+    auto futex_addr() -> std::uint32_t * {
+      static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+      return reinterpret_cast<std::uint32_t *>(static_cast<std::atomic<std::uint32_t> *>(&epoch_));
+    }
+
+    void futex_wait(std::uint32_t expected, const timespec *timeout) {
+      syscall(SYS_futex, futex_addr(), Shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+    }
+
+    void futex_wake(int cnt) {
+      syscall(SYS_futex, futex_addr(), Shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, cnt, nullptr, nullptr, 0);
+    }
+#else
+    static_assert(!Shared, "Process-shared EventCount requires futex.");
+#endif
+
+    auto notify(int cnt) -> bool {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters_.load(std::memory_order_relaxed) == 0) {
+        return false;
+      }
+      epoch_.fetch_add(1, std::memory_order_release);
+#if SIMPLECU_HAS_FUTEX
+      futex_wake(cnt);
+#else
+      cnt == 1 ? epoch_.notify_one() : epoch_.notify_all();
+#endif
+      return true;
+    }
+
+  public:
+    struct Key {
+      std::uint32_t epoch_;
+    };
+
+    BasicEventCount() = default;
+    BasicEventCount(const BasicEventCount &) = delete;
+    auto operator=(const BasicEventCount &) -> BasicEventCount & = delete;
+    BasicEventCount(BasicEventCount &&) = delete;
+    auto operator=(BasicEventCount &&) -> BasicEventCount & = delete;
+
+    auto prepare_wait() -> Key {
+      waiters_.fetch_add(1, std::memory_order_seq_cst);
+      return Key{epoch_.load(std::memory_order_seq_cst)};
+    }
+
+    void cancel_wait() {
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void wait(Key key) {
+      while (epoch_.load(std::memory_order_acquire) == key.epoch_) {
+#if SIMPLECU_HAS_FUTEX
+        futex_wait(key.epoch_, nullptr);
+#else
+        epoch_.wait(key.epoch_, std::memory_order_acquire);
+#endif
+      }
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return 超时返回 `false`. 没有 futex 时退化为让出时间片轮询.
+     */
+    template<typename Clock, typename Duration>
+    auto wait_until(Key key, const std::chrono::time_point<Clock, Duration> &deadline) -> bool {
+      bool notified{sleep_until(key, deadline)};
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+      return notified;
+    }
+
+    /**
+     * 与 `wait_until` 相同, 但返回后仍计为等待者, 由调用方之后 `cancel_wait`.
+     * 调用方可以在两者之间撤销自己对等待的登记 (如 `ShmQueue` 的 `Endpoint`).
+     */
+    template<typename Clock, typename Duration>
+    auto sleep_until(Key key, const std::chrono::time_point<Clock, Duration> &deadline) -> bool {
+      bool notified{true};
+      while (epoch_.load(std::memory_order_acquire) == key.epoch_) {
+        auto now{Clock::now()};
+        if (now >= deadline) {
+          notified = false;
+          break;
+        }
+#if SIMPLECU_HAS_FUTEX
+        auto remain{std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count()};
+        timespec timeout{static_cast<time_t>(remain / 1000000000), static_cast<long>(remain % 1000000000)};
+        futex_wait(key.epoch_, &timeout);
+#else
+        std::this_thread::yield();
+#endif
+      }
+      return notified;
+    }
+
+    /**
+     * 当前的等待者数量, 只是快照.
+     */
+    auto waiter_cnt() const -> std::uint32_t {
+      return waiters_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return 是否有等待者, 调用方可据此在多个 `EventCount` 中只唤醒一个.
+     */
+    auto notify_one() -> bool {
+      return notify(1);
+    }
+
+    auto notify_all() -> bool {
+      return notify(std::numeric_limits<int>::max());
+    }
+  };
+
+  using EventCount = BasicEventCount<>;
+
+} // namespace SimpleCU::Utils
@@ -0,0 +1,213 @@
+#pragma once
+#include "SimpleCU_Reclaim.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 以 fetch_add 分配槽位的无界 MPMC 队列 (FAAArrayQueue, LCRQ 的简化版).
+   *
+   * 队列是一串定长段, 每段有各自的 `enq_idx_` / `deq_idx_`. 入队和出队都先 `fetch_add` 认领下标,
+   * 竞争者各自拿到不同的槽位, 不会像 Michael-Scott 队列那样因 CAS 失败而整轮重试.
+   * 只有换段时才在 `next_` / `head_` / `tail_` 上 CAS, 频率为每 `SegmentSize` 个元素一次.
+   *
+   * 槽位状态 `Empty -> Full` 由入队方 CAS, 出队方以 exchange 置为 `Taken`. 出队方先到时槽位作废,
+   * 入队方取回元素并重新认领. 段在所有下标都已被出队方认领后由推进 `head_` 的线程 retire.
+   *
+   * @tparam ValType 元素类型.
+   * @tparam Reclaimer 段的回收策略, 默认 `Reclaim::QSBRPolicy`.
+   * @tparam SegmentSize 每段的槽位数.
+   * @tparam Allocator 段的分配器, 内部 rebind 到段类型.
+   */
+  template<typename ValType, typename Reclaimer = Reclaim::QSBRPolicy<>, std::size_t SegmentSize = 1024,
+           typename Allocator = std::allocator<ValType>>
+  class FAAQueue {
+  private:
+    enum class State : std::uint32_t {
+      Empty,
+      Full,
+      Taken,
+    };
+
+    struct Slot {
+      std::atomic<State> state_{State::Empty};
+      alignas(ValType) std::byte storage_[sizeof(ValType)];
+
+      auto val() -> ValType * {
+        return std::launder(reinterpret_cast<ValType *>(storage_));
+      }
+    };
+
+    struct Segment {
+      Utils::Aligned<std::atomic<std::size_t>> enq_idx_{};
+      Utils::Aligned<std::atomic<std::size_t>> deq_idx_{};
+      Utils::Aligned<std::atomic<Segment *>> next_{};
+      std::array<Slot, SegmentSize> slots_{};
+    };
+
+    using SegAlloc_ = typename std::allocator_traits<Allocator>::template rebind_alloc<Segment>;
+    using SegAllocTraits_ = std::allocator_traits<SegAlloc_>;
+
+    /**
+     * retire 时段内元素都已被取走, 只归还内存.
+     */
+    struct NodeOps {
+      Utils::AllocatorDeleter<Segment, SegAlloc_> deleter_;
+
+      static auto next(Segment *seg) -> Segment * {
+        return seg->next_.load(std::memory_order_relaxed);
+      }
+
+      void destroy(Segment *seg) {
+        deleter_(seg);
+      }
+    };
+
+    using Domain_ = typename Reclaimer::template Domain<Segment, NodeOps>;
+
+    Utils::Aligned<std::atomic<Segment *>> head_{};
+    Utils::Aligned<std::atomic<Segment *>> tail_{};
+    SegAlloc_ allocator_;
+    NodeOps ops_;
+    Domain_ domain_;
+
+    auto create_segment() -> Segment * {
+      Segment *seg{SegAllocTraits_::allocate(allocator_, 1)};
+      SegAllocTraits_::construct(allocator_, seg);
+      return seg;
+    }
+
+    /**
+     * 新段的第 0 个槽位预先放入元素, 挂上失败时取回元素并直接释放该段.
+     */
+    auto append_segment(Segment *last, std::optional<ValType> &val) -> bool {
+      Segment *new_seg{create_segment()};
+      Slot &first{new_seg->slots_[0]};
+      std::construct_at(first.val(), std::move(val.value()));
+      first.state_.store(State::Full, std::memory_order_relaxed);
+      new_seg->enq_idx_.store(1, std::memory_order_relaxed);
+      Segment *expected{};
+      if (last->next_.compare_exchange_strong(expected, new_seg, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        tail_.compare_exchange_strong(last, new_seg, std::memory_order_release, std::memory_order_relaxed);
+        return true;
+      }
+      val.emplace(std::move(*first.val()));
+      std::destroy_at(first.val());
+      ops_.destroy(new_seg);
+      return false;
+    }
+
+    void push_val(std::optional<ValType> &&val) {
+      auto guard{domain_.guard()};
+      while (true) {
+        Segment *seg{guard.protect(0, tail_)};
+        if (Segment *next{seg->next_.load(std::memory_order_acquire)}; next) {
+          tail_.compare_exchange_weak(seg, next, std::memory_order_release, std::memory_order_relaxed);
+          continue;
+        }
+        std::size_t idx{seg->enq_idx_.fetch_add(1, std::memory_order_relaxed)};
+        if (idx >= SegmentSize) {
+          if (seg == tail_.load(std::memory_order_acquire) && append_segment(seg, val)) {
+            return;
+          }
+          continue;
+        }
+        Slot &slot{seg->slots_[idx]};
+        std::construct_at(slot.val(), std::move(val.value()));
+        State expected{State::Empty};
+        if (slot.state_.compare_exchange_strong(expected, State::Full, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+          return;
+        }
+        val.emplace(std::move(*slot.val())); // 出队方已作废该槽位
+        std::destroy_at(slot.val());
+      }
+    }
+
+  public:
+    FAAQueue() : FAAQueue(Allocator{}) {
+    }
+
+    explicit FAAQueue(const Allocator &alloc)
+        : allocator_{alloc}, ops_{Utils::AllocatorDeleter<Segment, SegAlloc_>{allocator_}}, domain_{ops_} {
+      Segment *seg{create_segment()};
+      head_.store(seg, std::memory_order_relaxed);
+      tail_.store(seg, std::memory_order_relaxed);
+    }
+
+    FAAQueue(const FAAQueue &) = delete;
+    auto operator=(const FAAQueue &) -> FAAQueue & = delete;
+    FAAQueue(FAAQueue &&) = delete;
+    auto operator=(FAAQueue &&) -> FAAQueue & = delete;
+
+    /**
+     * 析构时不应有其他线程访问.
+     */
+    ~FAAQueue() {
+      Segment *seg{head_.load(std::memory_order_relaxed)};
+      while (seg) {
+        Segment *next{seg->next_.load(std::memory_order_relaxed)};
+        for (Slot &slot : seg->slots_) {
+          if (slot.state_.load(std::memory_order_relaxed) == State::Full) {
+            std::destroy_at(slot.val());
+          }
+        }
+        ops_.destroy(seg);
+        seg = next;
+      }
+    }
+
+    template<typename... Args>
+    void emplace(Args &&...args) {
+      push_val(std::optional<ValType>{std::in_place, std::forward<Args>(args)...});
+    }
+
+    void push(const ValType &val) {
+      emplace(val);
+    }
+
+    void push(ValType &&val) {
+      emplace(std::move(val));
+    }
+
+    auto pop() -> std::optional<ValType> {
+      while (true) {
+        Segment *retired{};
+        {
+          auto guard{domain_.guard()};
+          Segment *seg{guard.protect(0, head_)};
+          std::size_t deq{seg->deq_idx_.load(std::memory_order_relaxed)};
+          if (deq >= seg->enq_idx_.load(std::memory_order_relaxed) &&
+              !seg->next_.load(std::memory_order_acquire)) {
+            return std::nullopt;
+          }
+          std::size_t idx{seg->deq_idx_.fetch_add(1, std::memory_order_relaxed)};
+          if (idx >= SegmentSize) {
+            Segment *next{seg->next_.load(std::memory_order_acquire)};
+            if (!next) {
+              return std::nullopt;
+            }
+            Segment *expected{seg}; // `tail_` 先越过该段, 之后不会再有入队方 protect 到它
+            tail_.compare_exchange_strong(expected, next, std::memory_order_release, std::memory_order_relaxed);
+            if (head_.compare_exchange_strong(seg, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+              retired = seg;
+            }
+          } else {
+            Slot &slot{seg->slots_[idx]};
+            if (slot.state_.exchange(State::Taken, std::memory_order_acquire) == State::Full) {
+              std::optional<ValType> ret{std::move(*slot.val())};
+              std::destroy_at(slot.val());
+              return ret;
+            }
+          }
+        }
+        if (retired) {
+          domain_.retire(retired, retired);
+        }
+      }
+    }
+  };
+
+} // namespace SimpleCU
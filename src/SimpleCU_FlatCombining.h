@@ -0,0 +1,295 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU::Details {
+
+  template<typename ValType>
+  class SequentialStack {
+  private:
+    std::vector<ValType> vals_;
+
+  public:
+    void push(ValType &&val) {
+      vals_.push_back(std::move(val));
+    }
+
+    auto pop() -> std::optional<ValType> {
+      if (vals_.empty()) {
+        return std::nullopt;
+      }
+      std::optional<ValType> ret{std::move(vals_.back())};
+      vals_.pop_back();
+      return ret;
+    }
+  };
+
+  template<typename ValType>
+  class SequentialQueue {
+  private:
+    std::deque<ValType> vals_;
+
+  public:
+    void push(ValType &&val) {
+      vals_.push_back(std::move(val));
+    }
+
+    auto pop() -> std::optional<ValType> {
+      if (vals_.empty()) {
+        return std::nullopt;
+      }
+      std::optional<ValType> ret{std::move(vals_.front())};
+      vals_.pop_front();
+      return ret;
+    }
+  };
+
+  /**
+   * @brief Flat Combining.
+   *
+   * 每个线程在自己的发布记录上登记操作, 然后抢占 combiner 锁; 抢到的线程扫描所有记录, 对顺序容器批量执行,
+   * 其余线程只在自己的记录上等待结果. 顺序容器只被持锁的 combiner 访问, 其所在的 cacheline 不在线程间来回迁移.
+   *
+   * 线程退出时归还其记录, 之后的线程复用. 同时存活的线程超出 `ThreadCnt` 时多出的线程没有记录,
+   * 退化为持 combiner 锁直接操作, 直到该线程退出.
+   *
+   * @tparam ValType 元素类型.
+   * @tparam Sequential 顺序容器, 提供 `push(ValType &&)` 和 `pop() -> std::optional<ValType>`.
+   * @tparam ThreadCnt 最大记录数.
+   */
+  template<typename ValType, typename Sequential, std::size_t ThreadCnt>
+  class FlatCombining {
+  private:
+    enum class State : std::uint32_t {
+      Idle,
+      Push,
+      Pop,
+      Done,
+    };
+
+    struct Record {
+      std::atomic<State> state_{State::Idle};
+      std::optional<ValType> val_{};
+    };
+
+    using Record_ = Utils::Aligned<Record>;
+    using obj_idx_t_ = std::uint64_t;
+
+    /**
+     * `in_use_` 只在登记和线程退出时访问, 归还的记录处于 `Idle`, combiner 扫描到也会跳过.
+     * 由 `shared_ptr` 持有, 线程退出时若对象已析构则不再访问.
+     */
+    struct RecordTable {
+      std::array<Record_, ThreadCnt> records_;
+      std::array<std::atomic<bool>, ThreadCnt> in_use_;
+    };
+
+    struct LocalEntry {
+      Record *rec_;
+      std::weak_ptr<RecordTable> table_;
+      std::size_t idx_;
+    };
+
+    /**
+     * 线程退出时归还其在各个仍存活的对象中的记录.
+     */
+    struct LocalMap {
+      std::unordered_map<obj_idx_t_, LocalEntry> map_;
+
+      ~LocalMap() {
+        for (auto &[obj_idx, entry] : map_) {
+          if (std::shared_ptr<RecordTable> table{entry.table_.lock()}; table && entry.rec_) {
+            table->in_use_[entry.idx_].store(false, std::memory_order_release);
+          }
+        }
+      }
+
+      /**
+       * 其他线程析构的对象只能由本线程清理, 登记新对象时顺带清除.
+       */
+      void purge_expired() {
+        std::erase_if(map_, [](const auto &kv) { return kv.second.table_.expired(); });
+      }
+    };
+
+    constexpr static std::size_t combine_passes{4};
+
+    Utils::Aligned<std::atomic<bool>> combining_{};
+    Utils::Aligned<std::atomic<std::size_t>> record_cnt_{};
+    std::shared_ptr<RecordTable> table_;
+    Utils::Aligned<Sequential> seq_{};
+
+    inline static std::atomic<obj_idx_t_> next_obj_idx_{};
+    const obj_idx_t_ obj_idx_;
+    thread_local inline static LocalMap tls_map_;
+
+    auto register_at(std::size_t idx) -> Record * {
+      tls_map_.map_[obj_idx_] = LocalEntry{&table_->records_[idx], table_, idx};
+      return &table_->records_[idx];
+    }
+
+    /**
+     * 先复用已退出线程归还的记录, 没有再分配新的. `in_use_` 初始全为 `true`, 刚分配的下标不会被复用方抢走.
+     */
+    auto get_record() -> Record * {
+      auto iter{tls_map_.map_.find(obj_idx_)};
+      if (iter != tls_map_.map_.end()) {
+        return iter->second.rec_;
+      }
+      tls_map_.purge_expired();
+      std::size_t idx{record_cnt_.load(std::memory_order_acquire)};
+      for (std::size_t i = 0; i < idx; i++) {
+        bool expected{false};
+        if (table_->in_use_[i].compare_exchange_strong(expected, true, std::memory_order_acquire,
+                                                       std::memory_order_relaxed)) {
+          return register_at(i);
+        }
+      }
+      do {
+        if (idx >= ThreadCnt) {
+          tls_map_.map_[obj_idx_] = LocalEntry{nullptr, table_, 0};
+          return nullptr;
+        }
+      } while (!record_cnt_.compare_exchange_weak(idx, idx + 1, std::memory_order_release, std::memory_order_relaxed));
+      return register_at(idx);
+    }
+
+    auto try_lock() -> bool {
+      return !combining_.load(std::memory_order_relaxed) && !combining_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() {
+      combining_.store(false, std::memory_order_release);
+    }
+
+    void apply(Record &rec, State state) {
+      if (state == State::Push) {
+        seq_.push(std::move(rec.val_.value()));
+        rec.val_.reset();
+      } else {
+        rec.val_ = seq_.pop();
+      }
+      rec.state_.store(State::Done, std::memory_order_release);
+    }
+
+    /**
+     * 扫描若干轮, 某一轮没有新请求则提前结束.
+     */
+    void combine() {
+      std::size_t cnt{record_cnt_.load(std::memory_order_acquire)};
+      for (std::size_t pass = 0; pass < combine_passes; pass++) {
+        bool found{};
+        for (std::size_t i = 0; i < cnt; i++) {
+          Record &rec{table_->records_[i]};
+          State state{rec.state_.load(std::memory_order_acquire)};
+          if (state == State::Push || state == State::Pop) {
+            apply(rec, state);
+            found = true;
+          }
+        }
+        if (!found) {
+          break;
+        }
+      }
+    }
+
+    /**
+     * 发布请求后等待, 期间 combiner 锁空闲就自己成为 combiner.
+     */
+    auto execute(Record &rec, State state) -> std::optional<ValType> {
+      rec.state_.store(state, std::memory_order_release);
+      Utils::ExpBackoff<1, 64, true> backoff{};
+      while (rec.state_.load(std::memory_order_acquire) != State::Done) {
+        if (try_lock()) {
+          combine();
+          unlock();
+          continue;
+        }
+        backoff();
+      }
+      rec.state_.store(State::Idle, std::memory_order_relaxed);
+      return std::move(rec.val_);
+    }
+
+    auto execute_locked(std::optional<ValType> &&val, State state) -> std::optional<ValType> {
+      Utils::ExpBackoff<1, 64, true> backoff{};
+      while (!try_lock()) {
+        backoff();
+      }
+      std::optional<ValType> ret{};
+      if (state == State::Push) {
+        seq_.push(std::move(val.value()));
+      } else {
+        ret = seq_.pop();
+      }
+      unlock();
+      return ret;
+    }
+
+    auto submit(std::optional<ValType> &&val, State state) -> std::optional<ValType> {
+      Record *rec{get_record()};
+      if (!rec) {
+        return execute_locked(std::move(val), state);
+      }
+      rec->val_ = std::move(val);
+      return execute(*rec, state);
+    }
+
+  public:
+    FlatCombining()
+        : table_{std::make_shared<RecordTable>()}, obj_idx_{next_obj_idx_.fetch_add(1, std::memory_order_relaxed)} {
+      for (std::size_t i = 0; i < ThreadCnt; i++) {
+        table_->in_use_[i].store(true, std::memory_order_relaxed);
+      }
+    }
+
+    FlatCombining(const FlatCombining &) = delete;
+    auto operator=(const FlatCombining &) -> FlatCombining & = delete;
+    FlatCombining(FlatCombining &&) = delete;
+    auto operator=(FlatCombining &&) -> FlatCombining & = delete;
+
+    ~FlatCombining() {
+      tls_map_.map_.erase(obj_idx_);
+    }
+
+    /**
+     * 当前线程是否持有发布记录, 没有时退化为加锁操作.
+     */
+    auto has_record() -> bool {
+      return get_record() != nullptr;
+    }
+
+    void push(const ValType &val) {
+      submit(std::make_optional(val), State::Push);
+    }
+
+    void push(ValType &&val) {
+      submit(std::make_optional(std::move(val)), State::Push);
+    }
+
+    auto pop() -> std::optional<ValType> {
+      return submit(std::nullopt, State::Pop);
+    }
+  };
+
+} // namespace SimpleCU::Details
+
+namespace SimpleCU {
+
+  /**
+   * @brief Flat Combining 栈.
+   *
+   * @tparam ThreadCnt 最大线程数, 超出的线程退化为加锁操作.
+   */
+  template<typename ValType, std::size_t ThreadCnt = 64>
+  using FCStack = Details::FlatCombining<ValType, Details::SequentialStack<ValType>, ThreadCnt>;
+
+  /**
+   * @brief Flat Combining 队列.
+   *
+   * @tparam ThreadCnt 最大线程数, 超出的线程退化为加锁操作.
+   */
+  template<typename ValType, std::size_t ThreadCnt = 64>
+  using FCQueue = Details::FlatCombining<ValType, Details::SequentialQueue<ValType>, ThreadCnt>;
+
+} // namespace SimpleCU
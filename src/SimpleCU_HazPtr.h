@@ -5,10 +5,13 @@
 namespace SimpleCU::HazPtr::Details {
 
   namespace HazPtr {
-    template<typename ValType, std::size_t SlotSize>
+    template<typename ValType, std::size_t SlotSize, Utils::PaddingProfile Profile = Utils::DEFAULT_PADDING>
     class HazPtrContext {
     private:
-      std::array<Utils::Aligned<std::atomic<const ValType *>>, SlotSize> hazptr_;
+      using Slot_ = Utils::Aligned<std::atomic<const ValType *>, Profile>;
+      static_assert(Utils::is_padded_v<Slot_, Profile>, "Hazard pointer slots must not share padding units.");
+
+      std::array<Slot_, SlotSize> hazptr_;
 
     public:
       bool contains(const ValType *ptr) const {
@@ -30,11 +33,11 @@ namespace SimpleCU::HazPtr::Details {
         return true;
       }
 
-      void output(std::unordered_set<const ValType *> &out) {
+      void output(std::vector<const ValType *> &out) {
         for (std::size_t i = 0; i < SlotSize; i++) {
           const ValType *ptr{};
           if ((ptr = hazptr_[i].load(std::memory_order_acquire)) != nullptr) {
-            out.insert(ptr);
+            out.push_back(ptr);
           }
         }
       }
@@ -48,18 +51,26 @@ namespace SimpleCU::HazPtr::Details {
         RetiredNode *next_;
       };
       RetiredNode *retired_{};
+      RetiredNode *free_{};                       // 已 reclaim 的 `RetiredNode`, 复用以免每次 retire 分配
+      std::vector<const ValType *> hazptrs_buf_{}; // reclaim 时收集 hazard pointer 的缓冲区, 保留容量
       Utils::Aligned<std::atomic<std::size_t>> cnt_{};
 
+      static void delete_list(RetiredNode *node) {
+        while (node) {
+          RetiredNode *next{node->next_};
+          delete node;
+          node = next;
+        }
+      }
+
     public:
       RetiredContext() = default;
+      /**
+       * 元素本身由 `HazPtrManager` 析构时经 deleter reclaim, 此处只回收残留的链表节点.
+       */
       ~RetiredContext() {
-        RetiredNode *old_retired{retired_};
-        while (old_retired) {
-          RetiredNode *next{old_retired->next_};
-          delete old_retired->val_;
-          delete old_retired;
-          old_retired = next;
-        }
+        delete_list(retired_);
+        delete_list(free_);
       }
       RetiredContext(const RetiredContext &obj) = delete;
       RetiredContext &operator=(const RetiredContext &obj) = delete;
@@ -67,25 +78,41 @@ namespace SimpleCU::HazPtr::Details {
       RetiredContext &operator=(RetiredContext &&obj) = delete;
 
       void retire(ValType *val) {
-        RetiredNode *new_node{new RetiredNode{val, retired_}};
+        RetiredNode *new_node{free_};
+        if (new_node) {
+          free_ = new_node->next_;
+          new_node->val_ = val;
+          new_node->next_ = retired_;
+        } else {
+          new_node = new RetiredNode{val, retired_};
+        }
         retired_ = new_node;
-        cnt_.fetch_add(1, std::memory_order_relaxed);
+        cnt_.store(cnt_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // 只有所属线程写入
       }
 
       std::size_t get_cnt() const {
         return cnt_.load(std::memory_order_relaxed);
       }
 
-      void delete_no_hazard(const std::unordered_set<const ValType *> &hazptrs) {
+      auto get_hazptrs_buf() -> std::vector<const ValType *> & {
+        return hazptrs_buf_;
+      }
+
+      /**
+       * @param hazptrs 已排序的 hazard pointer 集合.
+       */
+      template<typename DeleterType_>
+      void delete_no_hazard(const std::vector<const ValType *> &hazptrs, DeleterType_ &&deleter) {
         RetiredNode *old_retired{retired_};
         std::uint64_t unsafe_cnt{};
         retired_ = nullptr;
         cnt_.store(0, std::memory_order_relaxed);
         while (old_retired) {
           RetiredNode *next{old_retired->next_};
-          if (!hazptrs.contains(old_retired->val_)) {
-            delete old_retired->val_; // ?
-            delete old_retired;
+          if (!std::binary_search(hazptrs.begin(), hazptrs.end(), old_retired->val_)) {
+            std::forward<DeleterType_>(deleter)(old_retired->val_);
+            old_retired->next_ = free_;
+            free_ = old_retired;
           } else {
             old_retired->next_ = retired_;
             retired_ = old_retired;
@@ -93,7 +120,7 @@ namespace SimpleCU::HazPtr::Details {
           }
           old_retired = next;
         }
-        cnt_.fetch_add(unsafe_cnt, std::memory_order_relaxed);
+        cnt_.store(unsafe_cnt, std::memory_order_relaxed);
       }
     };
   } // namespace HazPtr
@@ -109,39 +136,80 @@ namespace SimpleCU::HazPtr {
    * @tparam ValType 元素类型.
    * @tparam ThreadCnt 需要记录 Hazard Pointer 的线程总数.
    * @tparam SlotSize 每个线程需要的 Hazard Pointer 数量.
+   * @tparam DeleterType 自定义 deleter, 以 `ValType *` 调用. 可用 `Utils::AllocatorDeleter` 归还到 Allocator.
+   * @tparam Profile 槽位及每线程上下文的填充策略.
    */
-  template<typename ValType, std::size_t ThreadCnt, std::size_t SlotSize>
-  class HazPtrManager {
+  template<typename ValType, std::size_t ThreadCnt, std::size_t SlotSize,
+           typename DeleterType = Utils::DefaultDeleter<ValType>, Utils::PaddingProfile Profile = Utils::DEFAULT_PADDING>
+  class HazPtrManager : private Utils::EBODeleterStorage<DeleterType> {
   private:
-    using HazPtrContext_ = Utils::Aligned<Details::HazPtr::HazPtrContext<ValType, SlotSize>>;
-    using RetiredContext_ = Utils::Aligned<Details::HazPtr::RetiredContext<ValType>>;
+    using DeleterStorage_ = Utils::EBODeleterStorage<DeleterType>;
+    using HazPtrContext_ = Utils::Aligned<Details::HazPtr::HazPtrContext<ValType, SlotSize, Profile>, Profile>;
+    using RetiredContext_ = Utils::Aligned<Details::HazPtr::RetiredContext<ValType>, Profile>;
+    static_assert(Utils::is_padded_v<HazPtrContext_, Profile>, "HazPtrContext_ must not share padding units.");
 
-    std::array<Utils::Aligned<std::atomic<std::thread::id>>, ThreadCnt> ids_;
-    std::array<Utils::Aligned<std::atomic<HazPtrContext_ *>>, ThreadCnt> hazptr_ctxs_;
-    std::array<Utils::Aligned<std::atomic<RetiredContext_ *>>, ThreadCnt> retire_ctxs_;
+    std::array<Utils::Aligned<std::atomic<std::thread::id>, Profile>, ThreadCnt> ids_;
+    std::array<Utils::Aligned<std::atomic<HazPtrContext_ *>, Profile>, ThreadCnt> hazptr_ctxs_;
+    std::array<Utils::Aligned<std::atomic<RetiredContext_ *>, Profile>, ThreadCnt> retire_ctxs_;
     std::atomic<std::size_t> ctx_cnt_;
 
+    /**
+     * 线程退出时置位, 其上下文 (连同未回收的节点) 交给下一个注册的线程.
+     * 由 `shared_ptr` 持有, 线程退出时若 `HazPtrManager` 已析构则不再访问.
+     */
+    using ReleasedFlags_ = std::array<std::atomic<bool>, ThreadCnt>;
+    std::shared_ptr<ReleasedFlags_> released_{std::make_shared<ReleasedFlags_>()};
+
     /** Custom TLS specific to this object. */
     struct LocalEntry {
       HazPtrContext_ *local_hazptr_ctx_;
       RetiredContext_ *local_retired_ctx_;
+      std::weak_ptr<ReleasedFlags_> released_;
+      std::size_t ctx_idx_;
+    };
+
+    /**
+     * 线程退出时释放其在各个仍存活的 `HazPtrManager` 中的上下文, 此时所有 `Guard` 都已析构, hazard pointer 均为空.
+     */
+    struct LocalEntries {
+      std::vector<LocalEntry> entries_;
+
+      ~LocalEntries() {
+        for (LocalEntry &ent : entries_) {
+          if (std::shared_ptr<ReleasedFlags_> released{ent.released_.lock()}; released && ent.local_hazptr_ctx_) {
+            (*released)[ent.ctx_idx_].store(true, std::memory_order_release);
+          }
+        }
+      }
     };
+
     inline static std::atomic<std::size_t> next_idx_{};
     const std::size_t this_idx_;
-    thread_local inline static std::vector<LocalEntry> tls_;
+    thread_local inline static LocalEntries tls_;
 
     /**
      * 每个线程 `get_context` 操作的 `tls_` 都是自己 thread_local 的,
      * `tls_.resize()` 是安全的.
      */
     std::optional<std::pair<HazPtrContext_ *, RetiredContext_ *>> get_context() {
-      if (this_idx_ >= tls_.size()) {
-        tls_.resize(this_idx_ + 1);
+      if (this_idx_ >= tls_.entries_.size()) {
+        tls_.entries_.resize(this_idx_ + 1);
       }
-      LocalEntry &ent{tls_[this_idx_]};
+      LocalEntry &ent{tls_.entries_[this_idx_]};
       if (ent.local_hazptr_ctx_) {
         return std::make_pair(ent.local_hazptr_ctx_, ent.local_retired_ctx_);
       }
+      // 先复用已退出线程释放的上下文
+      for (std::size_t i = 0; i < ThreadCnt; i++) {
+        bool expected{true};
+        if ((*released_)[i].compare_exchange_strong(expected, false, std::memory_order_acquire,
+                                                    std::memory_order_relaxed)) {
+          ent = LocalEntry{hazptr_ctxs_[i].load(std::memory_order_relaxed),
+                           retire_ctxs_[i].load(std::memory_order_relaxed), released_, i};
+          ids_[i].store(std::this_thread::get_id(), std::memory_order_release);
+          return std::make_pair(ent.local_hazptr_ctx_, ent.local_retired_ctx_);
+        }
+      }
       if (ctx_cnt_.load(std::memory_order_relaxed) >= ThreadCnt) {
         return std::nullopt;
       }
@@ -153,8 +221,7 @@ namespace SimpleCU::HazPtr {
           ctx_cnt_.fetch_add(1, std::memory_order_relaxed);
           auto new_hazptr_ctx{new HazPtrContext_{}};
           auto new_retired_ctx{new RetiredContext_{}};
-          ent.local_hazptr_ctx_ = new_hazptr_ctx;
-          ent.local_retired_ctx_ = new_retired_ctx;
+          ent = LocalEntry{new_hazptr_ctx, new_retired_ctx, released_, i};
           hazptr_ctxs_[i] = new_hazptr_ctx;
           retire_ctxs_[i] = new_retired_ctx;
           ids_[i].store(std::this_thread::get_id(), std::memory_order_release);
@@ -165,26 +232,47 @@ namespace SimpleCU::HazPtr {
       return std::nullopt;
     }
 
-    std::unordered_set<const ValType *> collect_all_hazptrs() {
-      std::unordered_set<const ValType *> res{};
+    /**
+     * 收集到调用线程自己的缓冲区并排序, 稳态下不分配内存.
+     */
+    void collect_all_hazptrs(std::vector<const ValType *> &res) {
+      res.clear();
       std::thread::id tmp{};
       for (std::size_t i = 0; i < ThreadCnt; i++) {
         if (ids_[i].load(std::memory_order_acquire) != tmp) {
           hazptr_ctxs_[i].load(std::memory_order_relaxed)->output(res);
         }
       }
-      return res;
+      std::sort(res.begin(), res.end());
     }
 
   public:
     HazPtrManager() : this_idx_{next_idx_.fetch_add(1, std::memory_order_relaxed)} {
     }
+
+    /**
+     * 同 `QSBRManager`, 使用转发引用接收 deleter.
+     */
+    template<typename DeleterType_ = DeleterType,
+             typename Requires_ = std::enable_if_t<std::is_same_v<std::decay_t<DeleterType_>, DeleterType>>>
+    HazPtrManager(DeleterType_ &&deleter)
+        : DeleterStorage_{std::forward<DeleterType_>(deleter)},
+          this_idx_{next_idx_.fetch_add(1, std::memory_order_relaxed)} {
+    }
+
+    /**
+     * `HazPtrManager` 的生命周期应该晚于所有线程结束, 此时所有已 retire 的元素都不再被保护.
+     */
     ~HazPtrManager() {
       for (std::size_t i = 0; i < ThreadCnt; i++) {
         delete hazptr_ctxs_[i].load(std::memory_order_relaxed);
       }
       for (std::size_t i = 0; i < ThreadCnt; i++) {
-        delete retire_ctxs_[i].load(std::memory_order_relaxed);
+        RetiredContext_ *retired_ctx{retire_ctxs_[i].load(std::memory_order_relaxed)};
+        if (retired_ctx) {
+          retired_ctx->delete_no_hazard({}, this->get_deleter());
+        }
+        delete retired_ctx;
       }
     }
     HazPtrManager(const HazPtrManager &obj) = delete;
@@ -192,6 +280,11 @@ namespace SimpleCU::HazPtr {
     HazPtrManager(HazPtrManager &&obj) = delete;
     HazPtrManager &operator=(HazPtrManager &&obj) = delete;
 
+    /**
+     * 供持有者在确认无 hazard 时直接回收, 与 retire 路径使用同一个 deleter.
+     */
+    using DeleterStorage_::get_deleter;
+
     std::size_t get_max_hazptr_cnt_global() {
       return SlotSize * ThreadCnt;
     }
@@ -223,13 +316,17 @@ namespace SimpleCU::HazPtr {
       return hazptr_ctx->unset_hazptr(idx);
     }
 
-    void retire(ValType *ptr) {
+    /**
+     * @return 线程上下文已用尽时返回 `false`, `ptr` 未被接管.
+     */
+    bool retire(ValType *ptr) {
       auto context{get_context()};
       if (!context.has_value()) {
-        return;
+        return false;
       }
       RetiredContext_ *retired_ctx{context.value().second};
       retired_ctx->retire(ptr);
+      return true;
     }
 
     bool check_hazptr(const ValType *ptr) {
@@ -247,7 +344,9 @@ namespace SimpleCU::HazPtr {
         return;
       }
       RetiredContext_ *retired_ctx{context.value().second};
-      retired_ctx->delete_no_hazard(collect_all_hazptrs());
+      std::vector<const ValType *> &hazptrs{retired_ctx->get_hazptrs_buf()};
+      collect_all_hazptrs(hazptrs);
+      retired_ctx->delete_no_hazard(hazptrs, this->get_deleter());
     }
   };
 } // namespace SimpleCU::HazPtr
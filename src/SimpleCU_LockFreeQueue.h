@@ -0,0 +1,171 @@
+#pragma once
+#include "SimpleCU_NodePool.h"
+#include "SimpleCU_Reclaim.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief Michael-Scott 无锁 MPMC 队列, 回收策略在编译期选择.
+   *
+   * `head_` 始终指向哨兵, 元素位于哨兵之后的节点中. 节点先在本地构造好元素, 再 CAS 挂到尾节点的 `next_` 上,
+   * 消费者看到 `next_` 非空时元素一定已完整发布. `tail_` 允许落后一个节点, 任何线程发现落后都会帮忙推进.
+   *
+   * 出队的线程把新哨兵中的元素移出并析构, 旧哨兵交给策略 retire.
+   *
+   * @tparam ValType 元素类型.
+   * @tparam Reclaimer `Reclaim::QSBRPolicy` / `Reclaim::HazPtrPolicy` (至少 2 个槽位) / `Reclaim::LeakPolicy`.
+   * @tparam Allocator 节点的分配器, 内部 rebind 到节点类型. 默认经 `Utils::NodePool` 复用节点.
+   * @tparam Backoff CAS 失败后的退避策略.
+   */
+  template<typename ValType, typename Reclaimer = Reclaim::QSBRPolicy<>,
+           typename Allocator = Utils::PoolAllocator<ValType>, typename Backoff = Utils::NoBackoff>
+  class LockFreeQueue {
+  private:
+    struct Node {
+      alignas(ValType) std::byte storage_[sizeof(ValType)];
+      std::atomic<Node *> next_{};
+
+      auto val() -> ValType * {
+        return std::launder(reinterpret_cast<ValType *>(storage_));
+      }
+    };
+
+    using NodeAlloc_ = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits_ = std::allocator_traits<NodeAlloc_>;
+
+    /**
+     * 只 retire 单个哨兵, 元素已在出队时析构, 这里只归还节点.
+     */
+    struct NodeOps {
+      Utils::AllocatorDeleter<Node, NodeAlloc_> deleter_;
+
+      static auto next(Node *node) -> Node * {
+        return node->next_.load(std::memory_order_relaxed);
+      }
+
+      void destroy(Node *node) {
+        deleter_(node);
+      }
+    };
+
+    using Domain_ = typename Reclaimer::template Domain<Node, NodeOps>;
+
+    Utils::Aligned<std::atomic<Node *>> head_{};
+    Utils::Aligned<std::atomic<Node *>> tail_{};
+    NodeAlloc_ allocator_;
+    NodeOps ops_;
+    Domain_ domain_;
+
+    auto create_node() -> Node * {
+      Node *new_node{NodeAllocTraits_::allocate(allocator_, 1)};
+      NodeAllocTraits_::construct(allocator_, new_node);
+      return new_node;
+    }
+
+    void push_node(Node *new_node) {
+      auto guard{domain_.guard()};
+      Backoff backoff{};
+      while (true) {
+        Node *old_tail{guard.protect(0, tail_)};
+        Node *next{old_tail->next_.load(std::memory_order_acquire)};
+        if (old_tail != tail_.load(std::memory_order_acquire)) {
+          continue;
+        }
+        if (next) {
+          tail_.compare_exchange_weak(old_tail, next, std::memory_order_release, std::memory_order_relaxed);
+          continue;
+        }
+        if (old_tail->next_.compare_exchange_weak(next, new_node, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+          tail_.compare_exchange_strong(old_tail, new_node, std::memory_order_release, std::memory_order_relaxed);
+          return;
+        }
+        backoff();
+      }
+    }
+
+  public:
+    LockFreeQueue() : LockFreeQueue(Allocator{}) {
+    }
+
+    explicit LockFreeQueue(const Allocator &alloc)
+        : allocator_{alloc}, ops_{Utils::AllocatorDeleter<Node, NodeAlloc_>{allocator_}}, domain_{ops_} {
+      Node *sentinel{create_node()};
+      head_.store(sentinel, std::memory_order_relaxed);
+      tail_.store(sentinel, std::memory_order_relaxed);
+    }
+
+    LockFreeQueue(const LockFreeQueue &) = delete;
+    auto operator=(const LockFreeQueue &) -> LockFreeQueue & = delete;
+    LockFreeQueue(LockFreeQueue &&) = delete;
+    auto operator=(LockFreeQueue &&) -> LockFreeQueue & = delete;
+
+    /**
+     * 析构时不应有其他线程访问. 哨兵不含元素, 其后的节点都含元素.
+     */
+    ~LockFreeQueue() {
+      Node *cur{head_.load(std::memory_order_relaxed)};
+      Node *next{cur->next_.load(std::memory_order_relaxed)};
+      ops_.destroy(cur);
+      for (cur = next; cur; cur = next) {
+        next = cur->next_.load(std::memory_order_relaxed);
+        std::destroy_at(cur->val());
+        ops_.destroy(cur);
+      }
+    }
+
+    template<typename... Args>
+    void emplace(Args &&...args) {
+      Node *new_node{create_node()};
+      std::construct_at(new_node->val(), std::forward<Args>(args)...);
+      push_node(new_node);
+    }
+
+    void push(const ValType &val) {
+      emplace(val);
+    }
+
+    void push(ValType &&val) {
+      emplace(std::move(val));
+    }
+
+    /**
+     * `next` 由槽位 1 保护: 其他线程可能紧接着把 `next` 作为哨兵出队并 retire,
+     * 但那时当前线程已经不再需要它以外的节点.
+     */
+    auto pop() -> std::optional<ValType> {
+      Node *old_head{};
+      std::optional<ValType> ret{};
+      {
+        auto guard{domain_.guard()};
+        Backoff backoff{};
+        while (true) {
+          old_head = guard.protect(0, head_);
+          Node *old_tail{tail_.load(std::memory_order_acquire)};
+          Node *next{guard.protect(1, old_head->next_)};
+          if (old_head != head_.load(std::memory_order_acquire)) {
+            continue;
+          }
+          if (!next) {
+            return std::nullopt;
+          }
+          if (old_head == old_tail) {
+            tail_.compare_exchange_weak(old_tail, next, std::memory_order_release, std::memory_order_relaxed);
+            continue;
+          }
+          if (head_.compare_exchange_weak(old_head, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            ret.emplace(std::move(*next->val()));
+            std::destroy_at(next->val());
+            break;
+          }
+          backoff();
+        }
+      }
+      domain_.retire(old_head, old_head);
+      return ret;
+    }
+  };
+
+} // namespace SimpleCU
@@ -0,0 +1,295 @@
+#pragma once
+#include "SimpleCU_NodePool.h"
+#include "SimpleCU_Reclaim.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief Treiber 栈, 回收策略在编译期选择.
+   *
+   * 所有策略共用同一条热路径: `guard()` 进入保护, `protect` 读取 `head_`, CAS 摘下后交给策略 `retire`.
+   *
+   * @tparam ValType 元素类型.
+   * @tparam Reclaimer `Reclaim::QSBRPolicy` / `Reclaim::HazPtrPolicy` / `Reclaim::LeakPolicy`.
+   * @tparam Allocator 节点的分配器, 内部 rebind 到节点类型. 默认经 `Utils::NodePool` 复用节点.
+   * @tparam Backoff CAS 失败后的退避策略.
+   * @tparam EliminationWidth 消除数组槽位数, 为 0 时不使用消除.
+   */
+  template<typename ValType, typename Reclaimer = Reclaim::QSBRPolicy<>,
+           typename Allocator = Utils::PoolAllocator<ValType>, typename Backoff = Utils::NoBackoff,
+           std::size_t EliminationWidth = 0>
+  class LockFreeStack {
+  private:
+    struct Node {
+      ValType val_;
+      Node *next_;
+      template<typename... Args>
+      Node(std::in_place_t, Args &&...args) : val_(std::forward<Args>(args)...) {
+      }
+    };
+
+    using NodeAlloc_ = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits_ = std::allocator_traits<NodeAlloc_>;
+
+    /**
+     * 节点入栈后 `next_` 不再改变, 策略可以安全地沿 `next_` 遍历一段已摘下的节点.
+     */
+    struct NodeOps {
+      Utils::AllocatorDeleter<Node, NodeAlloc_> deleter_;
+
+      static auto next(Node *node) -> Node * {
+        return node->next_;
+      }
+
+      void destroy(Node *node) {
+        deleter_(node);
+      }
+    };
+
+    using Domain_ = typename Reclaimer::template Domain<Node, NodeOps>;
+
+    std::atomic<Node *> head_{};
+    NodeAlloc_ allocator_;
+    NodeOps ops_;
+    Domain_ domain_;
+
+    template<typename... Args>
+    auto create_node(Args &&...args) -> Node * {
+      Node *new_node{NodeAllocTraits_::allocate(allocator_, 1)};
+      NodeAllocTraits_::construct(allocator_, new_node, std::in_place, std::forward<Args>(args)...);
+      return new_node;
+    }
+
+    void push_node(Node *new_node) {
+      Node *expected = head_.load(std::memory_order_relaxed);
+      new_node->next_ = expected;
+      Backoff backoff{};
+      while (!head_.compare_exchange_weak(expected, new_node, std::memory_order_release, std::memory_order_relaxed)) {
+        if constexpr (EliminationWidth > 0) {
+          if (try_eliminate_push(new_node)) {
+            return;
+          }
+        }
+        new_node->next_ = expected;
+        backoff();
+      }
+    }
+
+    /**
+     * 消除数组. CAS `head_` 失败的 push 把节点挂到随机槽位上等待片刻, 同样失败的 pop 可以直接取走,
+     * 一对 push / pop 互相抵消而不必再竞争 `head_`.
+     *
+     * 槽位从挂上节点到清空始终归 push 方所有, 只有 push 方能把槽位写回 `nullptr`;
+     * pop 方只能把节点 CAS 为 `taken_tag`, 成功后独占该节点, 其他线程只比较指针值而不解引用,
+     * 因此取走的节点可以直接销毁, 不需要经过回收策略.
+     */
+    constexpr static std::size_t elimination_spin{64};
+    inline static Node *const taken_tag{reinterpret_cast<Node *>(alignof(Node))};
+    std::array<Utils::Aligned<std::atomic<Node *>>, EliminationWidth> elimination_{};
+
+    auto try_eliminate_push(Node *new_node) -> bool {
+      auto &slot{elimination_[Utils::fast_random() % EliminationWidth]};
+      Node *empty{};
+      if (!slot.compare_exchange_strong(empty, new_node, std::memory_order_release, std::memory_order_relaxed)) {
+        return false;
+      }
+      for (std::size_t i = 0; i < elimination_spin && slot.load(std::memory_order_relaxed) != taken_tag; i++) {
+        Utils::cpu_relax();
+      }
+      return slot.exchange(nullptr, std::memory_order_relaxed) == taken_tag;
+    }
+
+    auto try_eliminate_pop() -> Node * {
+      auto &slot{elimination_[Utils::fast_random() % EliminationWidth]};
+      Node *offered{slot.load(std::memory_order_relaxed)};
+      if (!offered || offered == taken_tag ||
+          !slot.compare_exchange_strong(offered, taken_tag, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return nullptr;
+      }
+      return offered;
+    }
+
+  public:
+    LockFreeStack() : LockFreeStack(Allocator{}) {
+    }
+
+    explicit LockFreeStack(const Allocator &alloc)
+        : allocator_{alloc}, ops_{Utils::AllocatorDeleter<Node, NodeAlloc_>{allocator_}}, domain_{ops_} {
+    }
+
+    LockFreeStack(const LockFreeStack &) = delete;
+    auto operator=(const LockFreeStack &) -> LockFreeStack & = delete;
+    LockFreeStack(LockFreeStack &&) = delete;
+    auto operator=(LockFreeStack &&) -> LockFreeStack & = delete;
+
+    /**
+     * 析构时不应有其他线程访问, 剩余节点直接销毁, 已 retire 的节点由 `domain_` 析构回收.
+     */
+    ~LockFreeStack() {
+      Node *cur{head_.load(std::memory_order_relaxed)};
+      while (cur) {
+        Node *next{cur->next_};
+        ops_.destroy(cur);
+        cur = next;
+      }
+    }
+
+    void push(const ValType &val) {
+      push_node(create_node(val));
+    }
+
+    void push(ValType &&val) {
+      push_node(create_node(std::move(val)));
+    }
+
+    /**
+     * 在节点内原地构造元素, 元素类型无需可拷贝或可默认构造.
+     */
+    template<typename... Args>
+    void emplace(Args &&...args) {
+      push_node(create_node(std::forward<Args>(args)...));
+    }
+
+    /**
+     * 摘下的节点在 retire 前只归当前线程所有, 可以在退出保护后再读取 `val_`.
+     */
+    auto pop() -> std::optional<ValType> {
+      Node *old_head{};
+      bool eliminated{};
+      {
+        auto guard{domain_.guard()};
+        Backoff backoff{};
+        while (true) {
+          old_head = guard.protect(0, head_);
+          if (!old_head || head_.compare_exchange_weak(old_head, old_head->next_, std::memory_order_seq_cst,
+                                                       std::memory_order_relaxed)) {
+            break;
+          }
+          if constexpr (EliminationWidth > 0) {
+            if ((old_head = try_eliminate_pop()) != nullptr) {
+              eliminated = true;
+              break;
+            }
+          }
+          backoff();
+        }
+      }
+
+      if (!old_head) {
+        return std::nullopt;
+      }
+
+      ValType ret{std::move(old_head->val_)};
+      if (eliminated) {
+        ops_.destroy(old_head);
+      } else {
+        domain_.retire(old_head, old_head);
+      }
+      return std::make_optional(std::move(ret));
+    }
+
+    /**
+     * 先在本地把 `[first, last)` 连成一条链, 再用一次 CAS 接到栈顶.
+     * 等价于依次 push 每个元素, 最后一个元素位于栈顶.
+     */
+    template<typename InputIt>
+    void push_range(InputIt first, InputIt last) {
+      if (first == last) {
+        return;
+      }
+      Node *chain_last{create_node(*first)};
+      Node *chain_first{chain_last};
+      for (++first; first != last; ++first) {
+        Node *new_node{create_node(*first)};
+        new_node->next_ = chain_first;
+        chain_first = new_node;
+      }
+      Node *expected = head_.load(std::memory_order_relaxed);
+      chain_last->next_ = expected;
+      Backoff backoff{};
+      while (
+          !head_.compare_exchange_weak(expected, chain_first, std::memory_order_release, std::memory_order_relaxed)) {
+        chain_last->next_ = expected;
+        backoff();
+      }
+    }
+
+    /**
+     * 一次 CAS 摘下至多 `cnt` 个节点, 整段交给策略 retire.
+     * 只有策略允许在保护期内沿 `next_` 遍历时才这样做: 节点不会被释放, 也不会被重新入栈, `head_` 未变则整段未变.
+     * 否则 (如 Hazard Pointer 只保护栈顶) 退化为逐个 pop.
+     */
+    auto pop_bulk(std::size_t cnt) -> std::vector<ValType> {
+      std::vector<ValType> res{};
+      if (cnt == 0) {
+        return res;
+      }
+
+      if constexpr (!Reclaimer::protects_traversal) {
+        while (res.size() < cnt) {
+          std::optional<ValType> val{pop()};
+          if (!val.has_value()) {
+            break;
+          }
+          res.emplace_back(std::move(val.value()));
+        }
+        return res;
+      } else {
+        Node *old_head{};
+        Node *last{};
+        std::size_t taken{};
+        {
+          auto guard{domain_.guard()};
+          Backoff backoff{};
+          old_head = guard.protect(0, head_);
+          while (old_head) {
+            last = old_head;
+            for (taken = 1; taken < cnt && last->next_; taken++) {
+              last = last->next_;
+            }
+            if (head_.compare_exchange_weak(old_head, last->next_, std::memory_order_seq_cst,
+                                            std::memory_order_acquire)) {
+              break;
+            }
+            backoff();
+          }
+        }
+
+        if (!old_head) {
+          return res;
+        }
+
+        res.reserve(taken);
+        for (Node *cur = old_head;; cur = cur->next_) {
+          res.emplace_back(std::move(cur->val_));
+          if (cur == last) {
+            break;
+          }
+        }
+        domain_.retire(old_head, last);
+        return res;
+      }
+    }
+
+    /**
+     * 一次 exchange 摘下整个栈. 其他线程可能仍在读其中节点的 `next_`, 因此仍交给策略 retire.
+     */
+    auto pop_all() -> std::vector<ValType> {
+      std::vector<ValType> res{};
+      Node *first{head_.exchange(nullptr, std::memory_order_acquire)};
+      if (!first) {
+        return res;
+      }
+      Node *last{};
+      for (Node *cur = first; cur; cur = cur->next_) {
+        res.emplace_back(std::move(cur->val_));
+        last = cur;
+      }
+      domain_.retire(first, last);
+      return res;
+    }
+  };
+
+} // namespace SimpleCU
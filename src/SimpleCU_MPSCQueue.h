@@ -0,0 +1,127 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief `MPSCQueue` 的侵入式挂钩, 元素类型公有继承它.
+   *
+   * 同一时刻一个节点只能位于一个队列中.
+   */
+  struct MPSCHook {
+    std::atomic<MPSCHook *> mpsc_next_{};
+  };
+
+  /**
+   * @brief 侵入式多生产者单消费者队列 (Vyukov).
+   *
+   * 生产者只做一次 `exchange` 加一次 store, 不会失败重试. 消费者独占 `tail_`, 只需普通的 load,
+   * 取出的节点归消费者所有, 因此不需要任何回收机制. 队列不分配也不释放节点.
+   *
+   * 生产者在 `exchange` 与链接前驱之间被挂起时, 其后入队的节点暂时不可见, `pop` 会返回 `nullptr`.
+   *
+   * @tparam Node 元素类型, 公有继承 `MPSCHook`.
+   */
+  template<typename Node>
+    requires std::derived_from<Node, MPSCHook>
+  class MPSCQueue {
+  private:
+    Utils::Aligned<std::atomic<MPSCHook *>> head_{};
+    Utils::Aligned<MPSCHook *> tail_{};
+    MPSCHook stub_{};
+
+    void push_hook(MPSCHook *hook) {
+      hook->mpsc_next_.store(nullptr, std::memory_order_relaxed);
+      MPSCHook *prev{head_.exchange(hook, std::memory_order_acq_rel)};
+      prev->mpsc_next_.store(hook, std::memory_order_release);
+    }
+
+  public:
+    /**
+     * @brief `drain` 取出的一段节点, 以 `next` 遍历, 末尾为 `nullptr`.
+     */
+    struct Chain {
+      Node *first_;
+      Node *last_;
+      std::size_t cnt_;
+    };
+
+    MPSCQueue() {
+      head_.store(&stub_, std::memory_order_relaxed);
+      tail_ = &stub_;
+    }
+
+    MPSCQueue(const MPSCQueue &) = delete;
+    auto operator=(const MPSCQueue &) -> MPSCQueue & = delete;
+    MPSCQueue(MPSCQueue &&) = delete;
+    auto operator=(MPSCQueue &&) -> MPSCQueue & = delete;
+
+    /**
+     * 节点已取出后才可调用, 再次入队会改写其中的链接.
+     */
+    static auto next(Node *node) -> Node * {
+      return static_cast<Node *>(node->mpsc_next_.load(std::memory_order_relaxed));
+    }
+
+    void push(Node *node) {
+      push_hook(node);
+    }
+
+    /**
+     * 仅消费者调用.
+     */
+    auto pop() -> Node * {
+      MPSCHook *tail{tail_};
+      MPSCHook *next{tail->mpsc_next_.load(std::memory_order_acquire)};
+      if (tail == &stub_) {
+        if (!next) {
+          return nullptr;
+        }
+        tail_ = next;
+        tail = next;
+        next = next->mpsc_next_.load(std::memory_order_acquire);
+      }
+      if (next) {
+        tail_ = next;
+        return static_cast<Node *>(tail);
+      }
+      if (tail != head_.load(std::memory_order_acquire)) {
+        return nullptr; // 有生产者尚未完成链接
+      }
+      push_hook(&stub_); // `tail` 是最后一个节点, 放入哨兵后才能把它取出
+      next = tail->mpsc_next_.load(std::memory_order_acquire);
+      if (next) {
+        tail_ = next;
+        return static_cast<Node *>(tail);
+      }
+      return nullptr;
+    }
+
+    /**
+     * 仅消费者调用, 至多取出 `max_cnt` 个当前可见的节点, 按入队顺序重新链接成一段.
+     * 取出的节点归消费者所有, 因此可以直接改写它们的链接, 段内不含哨兵.
+     */
+    auto drain(std::size_t max_cnt = std::numeric_limits<std::size_t>::max()) -> Chain {
+      Chain chain{};
+      while (chain.cnt_ < max_cnt) {
+        Node *node{pop()};
+        if (!node) {
+          break;
+        }
+        if (chain.last_) {
+          chain.last_->mpsc_next_.store(node, std::memory_order_relaxed);
+        } else {
+          chain.first_ = node;
+        }
+        chain.last_ = node;
+        chain.cnt_++;
+      }
+      if (chain.last_) {
+        chain.last_->mpsc_next_.store(nullptr, std::memory_order_relaxed);
+      }
+      return chain;
+    }
+  };
+
+} // namespace SimpleCU
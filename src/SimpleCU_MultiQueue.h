@@ -0,0 +1,151 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 松弛 FIFO 的 MPMC 队列 (MultiQueue).
+   *
+   * 内部为 `factor * thread_cnt` 个各自带 try-lock 的顺序队列, 元素带入队时间戳.
+   * 入队放入随机一个分片; 出队随机取两个分片, 从队首时间戳较早的一个取出 ("power of two choices").
+   * 分片加锁失败时换一个分片重试, 不在任何锁上排队.
+   *
+   * 出队的元素不一定是全局最早的, 期望的秩误差与分片数成正比: `factor` 越大竞争越少, 顺序越松.
+   *
+   * @tparam ValType 元素类型.
+   */
+  template<typename ValType>
+  class MultiQueue {
+  private:
+    using stamp_t_ = std::uint64_t;
+
+    constexpr static stamp_t_ empty_stamp{std::numeric_limits<stamp_t_>::max()};
+    /** 连续多少次抽到的两个分片都为空后, 扫描全部分片确认是否真的为空. */
+    constexpr static std::size_t empty_probes{4};
+
+    struct Shard {
+      std::atomic<bool> locked_{};
+      std::atomic<stamp_t_> front_stamp_{empty_stamp};
+      std::deque<std::pair<stamp_t_, ValType>> vals_{};
+
+      auto try_lock() -> bool {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+      }
+
+      void unlock() {
+        front_stamp_.store(vals_.empty() ? empty_stamp : vals_.front().first, std::memory_order_relaxed);
+        locked_.store(false, std::memory_order_release);
+      }
+    };
+
+    const std::size_t shard_cnt_;
+    std::unique_ptr<Utils::Aligned<Shard>[]> shards_;
+
+    static auto now() -> stamp_t_ {
+      return static_cast<stamp_t_>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    auto random_shard() -> Shard & {
+      return shards_[Utils::fast_random() % shard_cnt_];
+    }
+
+    auto pop_locked(Shard &shard) -> std::optional<ValType> {
+      if (shard.vals_.empty()) {
+        shard.unlock();
+        return std::nullopt;
+      }
+      std::optional<ValType> ret{std::move(shard.vals_.front().second)};
+      shard.vals_.pop_front();
+      shard.unlock();
+      return ret;
+    }
+
+    /**
+     * 逐个尝试所有分片, 全部为空才返回 `std::nullopt`.
+     */
+    auto pop_scan() -> std::optional<ValType> {
+      std::size_t beg{Utils::fast_random() % shard_cnt_};
+      for (std::size_t i = 0; i < shard_cnt_; i++) {
+        Shard &shard{shards_[(beg + i) % shard_cnt_]};
+        if (shard.front_stamp_.load(std::memory_order_relaxed) == empty_stamp) {
+          continue;
+        }
+        Utils::ExpBackoff<1, 64, true> backoff{};
+        while (!shard.try_lock()) {
+          backoff();
+        }
+        if (std::optional<ValType> ret{pop_locked(shard)}; ret.has_value()) {
+          return ret;
+        }
+      }
+      return std::nullopt;
+    }
+
+  public:
+    /**
+     * @param thread_cnt 预计的并发线程数.
+     * @param factor 松弛因子, 每个线程对应的分片数.
+     */
+    explicit MultiQueue(std::size_t thread_cnt = std::thread::hardware_concurrency(), std::size_t factor = 2)
+        : shard_cnt_{std::max<std::size_t>(2, std::max<std::size_t>(thread_cnt, 1) * std::max<std::size_t>(factor, 1))},
+          shards_{std::make_unique<Utils::Aligned<Shard>[]>(shard_cnt_)} {
+    }
+
+    MultiQueue(const MultiQueue &) = delete;
+    auto operator=(const MultiQueue &) -> MultiQueue & = delete;
+    MultiQueue(MultiQueue &&) = delete;
+    auto operator=(MultiQueue &&) -> MultiQueue & = delete;
+
+    auto shard_cnt() const -> std::size_t {
+      return shard_cnt_;
+    }
+
+    template<typename... Args>
+    void emplace(Args &&...args) {
+      stamp_t_ stamp{now()};
+      while (true) {
+        Shard &shard{random_shard()};
+        if (!shard.try_lock()) {
+          continue;
+        }
+        shard.vals_.emplace_back(std::piecewise_construct, std::forward_as_tuple(stamp),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+        shard.unlock();
+        return;
+      }
+    }
+
+    void push(const ValType &val) {
+      emplace(val);
+    }
+
+    void push(ValType &&val) {
+      emplace(std::move(val));
+    }
+
+    auto pop() -> std::optional<ValType> {
+      std::size_t empty_cnt{};
+      while (true) {
+        Shard &a{random_shard()};
+        Shard &b{random_shard()};
+        stamp_t_ stamp_a{a.front_stamp_.load(std::memory_order_relaxed)};
+        stamp_t_ stamp_b{b.front_stamp_.load(std::memory_order_relaxed)};
+        if (stamp_a == empty_stamp && stamp_b == empty_stamp) {
+          if (++empty_cnt >= empty_probes) {
+            return pop_scan();
+          }
+          continue;
+        }
+        Shard &shard{stamp_a <= stamp_b ? a : b};
+        if (!shard.try_lock()) {
+          continue;
+        }
+        if (std::optional<ValType> ret{pop_locked(shard)}; ret.has_value()) {
+          return ret;
+        }
+      }
+    }
+  };
+
+} // namespace SimpleCU
@@ -0,0 +1,207 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU::Utils {
+
+  /**
+   * @brief 定长块的节点池.
+   *
+   * 每个线程持有一段本地空闲链表, 分配和归还都只操作本地链表;
+   * 本地过多时整批 (`batch_size` 块) 放入全局无锁空闲批次栈, 本地为空时整批取回.
+   * 全局也为空时才向系统申请一个 chunk 并切分.
+   *
+   * chunk 在进程生命周期内不归还 (type-stable), 因此全局栈 pop 时读取一个可能已被取走的批次头是安全的,
+   * ABA 由打包在头指针高 16 位的版本号排除.
+   *
+   * @tparam BlockSize 块大小.
+   * @tparam BlockAlign 块对齐.
+   */
+  template<std::size_t BlockSize, std::size_t BlockAlign>
+  class NodePool {
+  private:
+    struct FreeBlock {
+      FreeBlock *next_;                     // 本地链表 / 批次内链表
+      std::atomic<FreeBlock *> next_batch_; // 仅批次头使用
+    };
+
+    using packed_t_ = std::uint64_t;
+    constexpr static std::uint32_t tag_shift{48};
+    constexpr static packed_t_ tag_one{1ull << tag_shift};
+    constexpr static packed_t_ ptr_mask{tag_one - 1};
+
+    constexpr static std::size_t block_align{std::max(BlockAlign, alignof(FreeBlock))};
+    constexpr static std::size_t block_size{(std::max(BlockSize, sizeof(FreeBlock)) + block_align - 1) /
+                                            block_align * block_align};
+    constexpr static std::size_t batch_size{64};
+    constexpr static std::size_t chunk_blocks{batch_size * 4};
+
+    /**
+     * 本地缓存. `cnt_` 只可能偏大 (线程退出时可能归还不满一批), 遍历时以 `nullptr` 为准.
+     */
+    struct LocalCache {
+      FreeBlock *head_{};
+      std::size_t cnt_{};
+
+      ~LocalCache() {
+        while (head_) {
+          instance().push_batch(detach_batch(*this));
+        }
+      }
+    };
+
+    std::atomic<packed_t_> free_batches_{};
+    std::atomic<FreeBlock *> chunks_{}; // 每个 chunk 的首块用于串联, 使 chunk 始终可达
+
+    thread_local inline static LocalCache cache_{};
+
+    static auto pack(FreeBlock *ptr, packed_t_ tag) -> packed_t_ {
+      return reinterpret_cast<packed_t_>(ptr) | (tag & ~ptr_mask);
+    }
+
+    static auto unpack_ptr(packed_t_ packed) -> FreeBlock * {
+      return reinterpret_cast<FreeBlock *>(packed & ptr_mask);
+    }
+
+    /** 从本地链表头摘下至多 `batch_size` 块. */
+    static auto detach_batch(LocalCache &cache) -> FreeBlock * {
+      FreeBlock *first{cache.head_};
+      FreeBlock *last{first};
+      std::size_t cnt{1};
+      while (cnt < batch_size && last->next_) {
+        last = last->next_;
+        cnt++;
+      }
+      cache.head_ = last->next_;
+      cache.cnt_ = cache.cnt_ > cnt ? cache.cnt_ - cnt : 0;
+      last->next_ = nullptr;
+      return first;
+    }
+
+    void push_batch(FreeBlock *batch) {
+      packed_t_ old{free_batches_.load(std::memory_order_relaxed)};
+      do {
+        batch->next_batch_.store(unpack_ptr(old), std::memory_order_relaxed);
+      } while (!free_batches_.compare_exchange_weak(old, pack(batch, old + tag_one), std::memory_order_release,
+                                                    std::memory_order_relaxed));
+    }
+
+    /**
+     * 读 `next_batch_` 时批次可能已被其他线程取走并交给用户改写, 读到的值无意义但内存仍有效,
+     * 此时头的版本号必然已变, CAS 失败.
+     */
+    auto pop_batch() -> FreeBlock * {
+      packed_t_ old{free_batches_.load(std::memory_order_acquire)};
+      while (FreeBlock *batch{unpack_ptr(old)}) {
+        FreeBlock *next{batch->next_batch_.load(std::memory_order_relaxed)};
+        if (free_batches_.compare_exchange_weak(old, pack(next, old + tag_one), std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+          return batch;
+        }
+      }
+      return nullptr;
+    }
+
+    auto new_chunk() -> FreeBlock * {
+      auto *raw{static_cast<std::byte *>(::operator new(block_size * chunk_blocks, std::align_val_t{block_align}))};
+      auto *header{reinterpret_cast<FreeBlock *>(raw)};
+      header->next_ = chunks_.load(std::memory_order_relaxed);
+      while (!chunks_.compare_exchange_weak(header->next_, header, std::memory_order_relaxed)) {
+      }
+      FreeBlock *head{};
+      for (std::size_t i = chunk_blocks - 1; i > 0; i--) {
+        auto *blk{reinterpret_cast<FreeBlock *>(raw + i * block_size)};
+        blk->next_ = head;
+        head = blk;
+      }
+      return head;
+    }
+
+    void refill(LocalCache &cache) {
+      if (FreeBlock *batch{pop_batch()}) {
+        cache.head_ = batch;
+        cache.cnt_ = batch_size;
+      } else {
+        cache.head_ = new_chunk();
+        cache.cnt_ = chunk_blocks - 1;
+      }
+    }
+
+    NodePool() = default;
+
+  public:
+    NodePool(const NodePool &) = delete;
+    auto operator=(const NodePool &) -> NodePool & = delete;
+    NodePool(NodePool &&) = delete;
+    auto operator=(NodePool &&) -> NodePool & = delete;
+
+    /**
+     * 有意不析构: 其他静态对象或线程的 `LocalCache` 可能在静态析构阶段仍会归还块.
+     */
+    static auto instance() -> NodePool & {
+      static NodePool *pool{new NodePool{}};
+      return *pool;
+    }
+
+    auto allocate() -> void * {
+      LocalCache &cache{cache_};
+      if (!cache.head_) {
+        refill(cache);
+      }
+      FreeBlock *blk{cache.head_};
+      cache.head_ = blk->next_;
+      cache.cnt_--;
+      return blk;
+    }
+
+    void deallocate(void *ptr) {
+      LocalCache &cache{cache_};
+      auto *blk{static_cast<FreeBlock *>(ptr)};
+      blk->next_ = cache.head_;
+      cache.head_ = blk;
+      if (++cache.cnt_ >= 2 * batch_size) {
+        push_batch(detach_batch(cache));
+      }
+    }
+  };
+
+  /**
+   * @brief 以 `NodePool` 分配单个对象的无状态 Allocator.
+   *
+   * 同一大小与对齐的类型共享一个池. 一次分配多个对象时退回 `std::allocator`.
+   */
+  template<typename ValType>
+  class PoolAllocator {
+  private:
+    using Pool_ = NodePool<sizeof(ValType), alignof(ValType)>;
+
+  public:
+    using value_type = ValType;
+
+    PoolAllocator() = default;
+    template<typename ValType_>
+    PoolAllocator(const PoolAllocator<ValType_> &) noexcept {
+    }
+
+    auto allocate(std::size_t n) -> ValType * {
+      if (n == 1) {
+        return static_cast<ValType *>(Pool_::instance().allocate());
+      }
+      return std::allocator<ValType>{}.allocate(n);
+    }
+
+    void deallocate(ValType *ptr, std::size_t n) {
+      if (n == 1) {
+        Pool_::instance().deallocate(ptr);
+        return;
+      }
+      std::allocator<ValType>{}.deallocate(ptr, n);
+    }
+
+    template<typename ValType_>
+    auto operator==(const PoolAllocator<ValType_> &) const noexcept -> bool {
+      return true;
+    }
+  };
+
+} // namespace SimpleCU::Utils
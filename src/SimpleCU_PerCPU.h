@@ -0,0 +1,299 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+#include <sys/sysinfo.h>
+
+#if defined(__x86_64__) && defined(__linux__) && __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#define SIMPLECU_HAS_RSEQ 1
+#else
+#define SIMPLECU_HAS_RSEQ 0
+#endif
+
+namespace SimpleCU::Utils::Details {
+
+  inline auto cpu_cnt() -> std::size_t {
+    return static_cast<std::size_t>(std::max(get_nprocs_conf(), 1));
+  }
+
+  /** 每线程固定的 shard 编号, 用于 rseq 不可用时的回退路径. */
+  inline auto thread_shard_idx() -> std::size_t {
+    static std::atomic<std::size_t> next_idx{};
+    thread_local std::size_t idx{next_idx.fetch_add(1, std::memory_order_relaxed)};
+    return idx;
+  }
+
+#if SIMPLECU_HAS_RSEQ
+
+#define SIMPLECU_RSEQ_STR_(x) #x
+#define SIMPLECU_RSEQ_STR(x) SIMPLECU_RSEQ_STR_(x)
+
+/**
+ * 定义 `struct rseq_cs` (start_ip = 1f, post_commit_offset = 2f - 1f, abort_ip = 4f),
+ * 并把它登记到当前线程 `struct rseq` 的 `rseq_cs` 字段 (偏移 8).
+ * 临界区以 `1:` 开始, 最后一条 (提交) 指令之后紧跟 `2:`.
+ * 被抢占 / 迁移 / 信号打断时内核把 ip 改到 `4:`, 其前 4 字节必须是注册时的签名.
+ */
+#define SIMPLECU_RSEQ_CS_BEGIN                                                                                       \
+  ".pushsection __rseq_cs, \"aw\"\n\t"                                                                               \
+  ".balign 32\n\t"                                                                                                   \
+  "3:\n\t"                                                                                                           \
+  ".long 0x0, 0x0\n\t"                                                                                               \
+  ".quad 1f, (2f - 1f), 4f\n\t"                                                                                      \
+  ".popsection\n\t"                                                                                                  \
+  "leaq 3b(%%rip), %%rax\n\t"                                                                                        \
+  "movq %%rax, %%fs:8(%[rseq_offset])\n\t"                                                                           \
+  "1:\n\t"                                                                                                           \
+  "cmpl %[cpu_id], %%fs:4(%[rseq_offset])\n\t"                                                                       \
+  "jnz %l[abort]\n\t"
+
+#define SIMPLECU_RSEQ_CS_ABORT                                                                                       \
+  ".pushsection __rseq_failure, \"ax\"\n\t"                                                                          \
+  ".byte 0x0f, 0xb9, 0x3d\n\t"                                                                                       \
+  ".long " SIMPLECU_RSEQ_STR(RSEQ_SIG) "\n\t"                                                                        \
+  "4:\n\t"                                                                                                           \
+  "jmp %l[abort]\n\t"                                                                                                \
+  ".popsection\n\t"
+
+  inline auto rseq_area() -> struct rseq * {
+    return reinterpret_cast<struct rseq *>(static_cast<char *>(__builtin_thread_pointer()) + __rseq_offset);
+  }
+
+  /** glibc 已为所有线程注册 rseq 时可用, 可用 `GLIBC_TUNABLES=glibc.pthread.rseq=0` 关闭. */
+  inline auto rseq_available() -> bool {
+    return __rseq_size > 0;
+  }
+
+  /** 未注册时返回负数. */
+  inline auto rseq_current_cpu() -> int {
+    return static_cast<int>(__atomic_load_n(&rseq_area()->cpu_id, __ATOMIC_RELAXED));
+  }
+
+  /** `*v += count`, 仅当当前仍运行在 `cpu` 上时提交. 被中断返回 `false`, 需重新读取 cpu 后重试. */
+  inline auto rseq_addv(std::intptr_t *v, std::intptr_t count, int cpu) -> bool {
+    asm goto(SIMPLECU_RSEQ_CS_BEGIN "addq %[count], %[v]\n\t"
+                                    "2:\n\t" SIMPLECU_RSEQ_CS_ABORT
+             :
+             : [cpu_id] "r"(cpu), [rseq_offset] "r"(__rseq_offset), [v] "m"(*v), [count] "er"(count)
+             : "memory", "cc", "rax"
+             : abort);
+    return true;
+  abort:
+    return false;
+  }
+
+  enum class RseqResult {
+    Committed,
+    Rejected, // 容量不足 / 为空, 未修改.
+    Aborted,  // 被中断, 需重试.
+  };
+
+  /** 若 `*cnt < capacity`, 写入 `slots[*cnt] = val` 再以 `*cnt += 1` 提交. */
+  inline auto rseq_push(std::intptr_t *cnt, std::intptr_t *slots, std::intptr_t capacity, std::intptr_t val, int cpu)
+      -> RseqResult {
+    asm goto(SIMPLECU_RSEQ_CS_BEGIN "movq %[cnt], %%rax\n\t"
+                                    "cmpq %[capacity], %%rax\n\t"
+                                    "jae %l[rejected]\n\t"
+                                    "movq %[val], (%[slots], %%rax, 8)\n\t"
+                                    "incq %%rax\n\t"
+                                    "movq %%rax, %[cnt]\n\t"
+                                    "2:\n\t" SIMPLECU_RSEQ_CS_ABORT
+             :
+             : [cpu_id] "r"(cpu), [rseq_offset] "r"(__rseq_offset), [cnt] "m"(*cnt), [slots] "r"(slots),
+               [capacity] "r"(capacity), [val] "r"(val)
+             : "memory", "cc", "rax"
+             : rejected, abort);
+    return RseqResult::Committed;
+  rejected:
+    return RseqResult::Rejected;
+  abort:
+    return RseqResult::Aborted;
+  }
+
+  /** 若 `*cnt > 0`, 读出 `slots[*cnt - 1]` 再以 `*cnt -= 1` 提交, 提交后写回 `*out`. */
+  inline auto rseq_pop(std::intptr_t *cnt, std::intptr_t *slots, std::intptr_t *out, int cpu) -> RseqResult {
+    asm goto(SIMPLECU_RSEQ_CS_BEGIN "movq %[cnt], %%rax\n\t"
+                                    "testq %%rax, %%rax\n\t"
+                                    "jz %l[rejected]\n\t"
+                                    "decq %%rax\n\t"
+                                    "movq (%[slots], %%rax, 8), %%rcx\n\t"
+                                    "movq %%rax, %[cnt]\n\t"
+                                    "2:\n\t"
+                                    "movq %%rcx, %[out]\n\t" SIMPLECU_RSEQ_CS_ABORT
+             :
+             : [cpu_id] "r"(cpu), [rseq_offset] "r"(__rseq_offset), [cnt] "m"(*cnt), [slots] "r"(slots),
+               [out] "m"(*out)
+             : "memory", "cc", "rax", "rcx"
+             : rejected, abort);
+    return RseqResult::Committed;
+  rejected:
+    return RseqResult::Rejected;
+  abort:
+    return RseqResult::Aborted;
+  }
+
+#undef SIMPLECU_RSEQ_CS_BEGIN
+#undef SIMPLECU_RSEQ_CS_ABORT
+
+#else
+
+  inline auto rseq_available() -> bool {
+    return false;
+  }
+
+#endif
+
+} // namespace SimpleCU::Utils::Details
+
+namespace SimpleCU::Utils {
+
+  /**
+   * @brief 按 CPU 分片的计数器.
+   *
+   * rseq 可用时, 更新为当前 CPU 分片上的一条普通 `add`, 没有 `lock` 前缀;
+   * 否则回退到按线程分片的 relaxed `fetch_add`. 两条路径使用各自的分片, 不会互相覆盖.
+   * `load` 对所有分片求和, 只保证最终一致.
+   */
+  class ShardedCounter {
+  private:
+    using Shard_ = Aligned<std::atomic<std::intptr_t>>;
+
+    std::vector<Shard_> cpu_shards_;
+    std::vector<Shard_> thread_shards_;
+
+  public:
+    ShardedCounter() : cpu_shards_(Details::cpu_cnt()), thread_shards_(Details::cpu_cnt()) {
+    }
+    ShardedCounter(const ShardedCounter &) = delete;
+    auto operator=(const ShardedCounter &) -> ShardedCounter & = delete;
+
+    void add(std::intptr_t cnt) {
+#if SIMPLECU_HAS_RSEQ
+      if (Details::rseq_available()) {
+        int cpu{};
+        while ((cpu = Details::rseq_current_cpu()) >= 0 && static_cast<std::size_t>(cpu) < cpu_shards_.size()) {
+          if (Details::rseq_addv(reinterpret_cast<std::intptr_t *>(&cpu_shards_[cpu]), cnt, cpu)) {
+            return;
+          }
+        }
+      }
+#endif
+      thread_shards_[Details::thread_shard_idx() % thread_shards_.size()].fetch_add(cnt, std::memory_order_relaxed);
+    }
+
+    void sub(std::intptr_t cnt) {
+      add(-cnt);
+    }
+
+    auto load() const -> std::intptr_t {
+      std::intptr_t sum{};
+      for (const Shard_ &shard : cpu_shards_) {
+        sum += shard.load(std::memory_order_relaxed);
+      }
+      for (const Shard_ &shard : thread_shards_) {
+        sum += shard.load(std::memory_order_relaxed);
+      }
+      return sum;
+    }
+  };
+
+  /**
+   * @brief 每 CPU 一个定长的指针槽位栈, 作为空闲链表 / 对象缓存的快速路径.
+   *
+   * rseq 可用时 `try_push` / `try_pop` 都是当前 CPU 上的普通读写, 无原子 RMW;
+   * 否则回退到按线程分片, 每个分片用自旋锁保护.
+   * 不拥有存入的指针, 析构时剩余指针需由调用方通过 `try_pop` 取回.
+   *
+   * @tparam ValType 指针指向的类型.
+   * @tparam SlotCnt 每个 CPU 的槽位数.
+   */
+  template<typename ValType, std::size_t SlotCnt = 64>
+  class PerCPUSlots {
+  private:
+    struct Buffer {
+      std::atomic<std::intptr_t> cnt_{};
+      std::array<std::intptr_t, SlotCnt> slots_{};
+      std::atomic_flag lock_{};
+    };
+    using Buffer_ = Aligned<Buffer>;
+
+    std::vector<Buffer_> cpu_bufs_;
+    std::vector<Buffer_> thread_bufs_;
+
+    auto lock_thread_buf() -> Buffer_ & {
+      Buffer_ &buf{thread_bufs_[Details::thread_shard_idx() % thread_bufs_.size()]};
+      ExpBackoff<1, 64, true> backoff{};
+      while (buf.lock_.test_and_set(std::memory_order_acquire)) {
+        backoff();
+      }
+      return buf;
+    }
+
+  public:
+    PerCPUSlots() : cpu_bufs_(Details::cpu_cnt()), thread_bufs_(Details::cpu_cnt()) {
+    }
+    PerCPUSlots(const PerCPUSlots &) = delete;
+    auto operator=(const PerCPUSlots &) -> PerCPUSlots & = delete;
+
+    /** 当前 CPU 的槽位已满时返回 `false`. */
+    auto try_push(ValType *ptr) -> bool {
+#if SIMPLECU_HAS_RSEQ
+      if (Details::rseq_available()) {
+        int cpu{};
+        while ((cpu = Details::rseq_current_cpu()) >= 0 && static_cast<std::size_t>(cpu) < cpu_bufs_.size()) {
+          Buffer_ &buf{cpu_bufs_[cpu]};
+          switch (Details::rseq_push(reinterpret_cast<std::intptr_t *>(&buf.cnt_), buf.slots_.data(), SlotCnt,
+                                     reinterpret_cast<std::intptr_t>(ptr), cpu)) {
+            case Details::RseqResult::Committed:
+              return true;
+            case Details::RseqResult::Rejected:
+              return false;
+            case Details::RseqResult::Aborted:
+              break;
+          }
+        }
+      }
+#endif
+      Buffer_ &buf{lock_thread_buf()};
+      std::intptr_t cnt{buf.cnt_.load(std::memory_order_relaxed)};
+      bool pushed{static_cast<std::size_t>(cnt) < SlotCnt};
+      if (pushed) {
+        buf.slots_[cnt] = reinterpret_cast<std::intptr_t>(ptr);
+        buf.cnt_.store(cnt + 1, std::memory_order_relaxed);
+      }
+      buf.lock_.clear(std::memory_order_release);
+      return pushed;
+    }
+
+    /** 当前 CPU 的槽位为空时返回 `nullptr`. */
+    auto try_pop() -> ValType * {
+#if SIMPLECU_HAS_RSEQ
+      if (Details::rseq_available()) {
+        int cpu{};
+        while ((cpu = Details::rseq_current_cpu()) >= 0 && static_cast<std::size_t>(cpu) < cpu_bufs_.size()) {
+          Buffer_ &buf{cpu_bufs_[cpu]};
+          std::intptr_t out{};
+          switch (Details::rseq_pop(reinterpret_cast<std::intptr_t *>(&buf.cnt_), buf.slots_.data(), &out, cpu)) {
+            case Details::RseqResult::Committed:
+              return reinterpret_cast<ValType *>(out);
+            case Details::RseqResult::Rejected:
+              return nullptr;
+            case Details::RseqResult::Aborted:
+              break;
+          }
+        }
+      }
+#endif
+      Buffer_ &buf{lock_thread_buf()};
+      std::intptr_t cnt{buf.cnt_.load(std::memory_order_relaxed)};
+      ValType *res{};
+      if (cnt > 0) {
+        res = reinterpret_cast<ValType *>(buf.slots_[cnt - 1]);
+        buf.cnt_.store(cnt - 1, std::memory_order_relaxed);
+      }
+      buf.lock_.clear(std::memory_order_release);
+      return res;
+    }
+  };
+
+} // namespace SimpleCU::Utils
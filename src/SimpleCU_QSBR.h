@@ -21,18 +21,22 @@ namespace SimpleCU::QSBR::Details {
     };
 
     RetiredNode *retired_{};
+    RetiredNode *free_{}; // 已 reclaim 的 `RetiredNode`, 连同快照的容量一起复用
     std::atomic<std::uint64_t> cnt_{};
 
+    static void delete_list(RetiredNode *node) {
+      while (node) {
+        RetiredNode *next{node->next_};
+        delete node;
+        node = next;
+      }
+    }
+
   public:
     RetiredContext() = default;
     ~RetiredContext() {
-      RetiredNode *old_retired{retired_};
-      while (old_retired) {
-        RetiredNode *next{old_retired->next_};
-        // delete_val(std::move(old_retired->val_));
-        delete old_retired;
-        old_retired = next;
-      }
+      delete_list(retired_);
+      delete_list(free_);
     }
     RetiredContext(const RetiredContext &obj) = delete;
     RetiredContext &operator=(const RetiredContext &obj) = delete;
@@ -43,10 +47,22 @@ namespace SimpleCU::QSBR::Details {
       return cnt_.load(std::memory_order_relaxed);
     }
 
-    void retire(ValType &&val, CriticalEpochSnapshot_ &&snapshot) {
-      RetiredNode *new_node{new RetiredNode{std::move(val), std::move(snapshot), retired_}};
+    /**
+     * `take_snapshot` 直接写入复用节点的快照, 稳态下 retire 不分配内存.
+     */
+    template<typename SnapshotFunc>
+    void retire(ValType &&val, SnapshotFunc &&take_snapshot) {
+      RetiredNode *new_node{free_};
+      if (new_node) {
+        free_ = new_node->next_;
+        new_node->val_ = std::move(val);
+      } else {
+        new_node = new RetiredNode{std::move(val), {}, nullptr};
+      }
+      std::forward<SnapshotFunc>(take_snapshot)(new_node->critical_snapshot_);
+      new_node->next_ = retired_;
       retired_ = new_node;
-      cnt_.fetch_add(1, std::memory_order_relaxed);
+      cnt_.store(cnt_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // 只有所属线程写入
     }
 
     template<std::size_t Size, typename DeleterType_ = DeleterType>
@@ -70,11 +86,12 @@ namespace SimpleCU::QSBR::Details {
           unsafe_cnt++;
         } else {
           std::forward<DeleterType_>(deleter)(std::move(old_retired->val_));
-          delete old_retired;
+          old_retired->next_ = free_;
+          free_ = old_retired;
         }
         old_retired = next;
       }
-      cnt_.fetch_add(unsafe_cnt, std::memory_order_relaxed);
+      cnt_.store(unsafe_cnt, std::memory_order_relaxed);
     }
   };
 
@@ -88,8 +105,10 @@ namespace SimpleCU::QSBR {
    * @tparam ThreadCnt 最大线程数.
    * @tparam ValType 受管理的确切类型.
    * @tparam DeleterType 自定义 deleter.
+   * @tparam Profile 每线程上下文的填充策略.
    */
-  template<std::size_t ThreadCnt, typename ValType, typename DeleterType = Utils::DefaultDeleter<ValType>>
+  template<std::size_t ThreadCnt, typename ValType, typename DeleterType = Utils::DefaultDeleter<ValType>,
+           Utils::PaddingProfile Profile = Utils::DEFAULT_PADDING>
   class QSBRManager : private Utils::EBODeleterStorage<DeleterType> {
   private:
     static_assert(ThreadCnt <= std::numeric_limits<std::uint16_t>::max(), "Too much threads.");
@@ -102,7 +121,8 @@ namespace SimpleCU::QSBR {
 
     using Epoch_ = std::atomic<epoch_t_>;
     using RetiredContext_ = Details::RetiredContext<ValType, DeleterType>;
-    using QSBRContext_ = Utils::Aligned<std::pair<Epoch_, RetiredContext_>>;
+    using QSBRContext_ = Utils::Aligned<std::pair<Epoch_, RetiredContext_>, Profile>;
+    static_assert(Utils::is_padded_v<QSBRContext_, Profile>, "QSBRContext_ must not share padding units.");
 
     using CriticalEpochSnapshot_ = std::vector<std::pair<ctx_idx_t_, masked_epoch_t>>;
 
@@ -113,53 +133,91 @@ namespace SimpleCU::QSBR {
 
     /**
      * `Epoch_` 和 `RetiredContext_` 共用 Cacheline .
+     * `in_use_` 只在注册和线程退出时访问. 线程退出后其上下文 (连同未回收的节点) 交给下一个注册的线程.
+     * 由 `shared_ptr` 持有, 线程退出时若 `QSBRManager` 已析构则不再访问.
      */
-    std::unique_ptr<std::array<QSBRContext_, ThreadCnt>> ctxs_;
+    struct ContextTable {
+      std::array<QSBRContext_, ThreadCnt> ctxs_;
+      std::array<std::atomic<bool>, ThreadCnt> in_use_;
+    };
+
+    std::shared_ptr<ContextTable> table_;
     std::atomic<ctx_idx_t_> next_ctx_idx_{};
 
     struct LocalEntry {
       QSBRContext_ *local_qsbr_ctx_;
+      std::uint32_t depth_; // 临界区嵌套层数, 只有最外层改变 Epoch
+      std::weak_ptr<ContextTable> table_;
+      ctx_idx_t_ ctx_idx_;
+    };
+
+    /**
+     * 线程退出时释放其在各个仍存活的 `QSBRManager` 中的上下文. 仍在临界区内的上下文不释放.
+     */
+    struct LocalMap {
+      std::unordered_map<mgr_idx_t_, LocalEntry> map_;
+
+      ~LocalMap() {
+        for (auto &[mgr_idx, entry] : map_) {
+          if (std::shared_ptr<ContextTable> table{entry.table_.lock()}; table && entry.depth_ == 0) {
+            table->in_use_[entry.ctx_idx_].store(false, std::memory_order_release);
+          }
+        }
+      }
     };
 
     inline static std::atomic<mgr_idx_t_> next_mgr_idx_{};
     const mgr_idx_t_ mgr_idx_;
-    thread_local inline static std::unordered_map<mgr_idx_t_, LocalEntry> tls_map_;
+    thread_local inline static LocalMap tls_map_;
 
     /** 奇数 Epoch 则此线程位于临界区. */
     auto is_critical_epoch(epoch_t_ epoch) -> bool {
       return (epoch & 1) == 1;
     }
 
-    auto get_context() -> std::optional<LocalEntry> {
-      auto iter{tls_map_.find(mgr_idx_)};
-      if (iter != tls_map_.end()) {
-        return std::make_optional(iter->second);
+    auto register_at(ctx_idx_t_ idx) -> LocalEntry * {
+      return &(tls_map_.map_[mgr_idx_] = LocalEntry{&table_->ctxs_[idx], 0, table_, idx});
+    }
+
+    /**
+     * `std::unordered_map` 的元素地址在 rehash 后不变.
+     * 先复用已退出线程释放的上下文, 没有再分配新的. `in_use_` 初始全为 `true`, 刚分配的下标不会被复用方抢走.
+     */
+    auto get_context() -> LocalEntry * {
+      auto iter{tls_map_.map_.find(mgr_idx_)};
+      if (iter != tls_map_.map_.end()) {
+        return &iter->second;
       }
       // Register this new thread.
-      ctx_idx_t_ cur_ctx_idx_{next_ctx_idx_.load(std::memory_order_relaxed)};
+      ctx_idx_t_ cur_ctx_idx_{next_ctx_idx_.load(std::memory_order_acquire)};
+      for (ctx_idx_t_ i = 0; i < cur_ctx_idx_; i++) {
+        bool expected{false};
+        if (table_->in_use_[i].compare_exchange_strong(expected, true, std::memory_order_acquire,
+                                                       std::memory_order_relaxed)) {
+          return register_at(i);
+        }
+      }
       do {
         if (cur_ctx_idx_ >= ThreadCnt) {
-          return std::nullopt;
+          return nullptr;
         }
       } while (!next_ctx_idx_.compare_exchange_weak(cur_ctx_idx_, cur_ctx_idx_ + 1, std::memory_order_release,
                                                     std::memory_order_relaxed));
       // Registered.
-      tls_map_[mgr_idx_] = LocalEntry{&(*ctxs_)[cur_ctx_idx_]};
-      return tls_map_[mgr_idx_];
+      return register_at(cur_ctx_idx_);
     }
 
-    auto snapshot_critical_epochs() -> CriticalEpochSnapshot_ {
+    void snapshot_critical_epochs(CriticalEpochSnapshot_ &snapshot) {
       ctx_idx_t_ end_idx{next_ctx_idx_.load(std::memory_order_acquire)};
-      CriticalEpochSnapshot_ snapshot{};
+      snapshot.clear();
       snapshot.reserve(end_idx / 2);
       for (ctx_idx_t_ i = 0; i < end_idx; i++) {
         masked_epoch_t epoch_i{
-            static_cast<masked_epoch_t>((*ctxs_)[i].first.load(std::memory_order_acquire) & epoch_mask)};
+            static_cast<masked_epoch_t>(table_->ctxs_[i].first.load(std::memory_order_acquire) & epoch_mask)};
         if (is_critical_epoch(epoch_i)) {
           snapshot.emplace_back(std::make_pair(i, epoch_i));
         }
       }
-      return snapshot;
     }
 
     /** 栈上分配定长的 `FullEpochSnapshot_<ThreadCnt>` 避免 `new` 带来的锁开销. */
@@ -167,7 +225,7 @@ namespace SimpleCU::QSBR {
       ctx_idx_t_ end_idx{next_ctx_idx_.load(std::memory_order_acquire)};
       FullEpochSnapshot_<ThreadCnt> snapshot{};
       for (ctx_idx_t_ i = 0; i < end_idx; i++) {
-        snapshot[i] = static_cast<masked_epoch_t>((*ctxs_)[i].first.load(std::memory_order_acquire) & epoch_mask);
+        snapshot[i] = static_cast<masked_epoch_t>(table_->ctxs_[i].first.load(std::memory_order_acquire) & epoch_mask);
       }
       return snapshot;
     }
@@ -179,10 +237,10 @@ namespace SimpleCU::QSBR {
      * 不存在 idx 后操作对其他线程尚未可见的问题.
      */
     QSBRManager()
-        : ctxs_{std::make_unique<std::array<QSBRContext_, ThreadCnt>>()},
-          mgr_idx_{next_mgr_idx_.fetch_add(1, std::memory_order_relaxed)} {
+        : table_{std::make_shared<ContextTable>()}, mgr_idx_{next_mgr_idx_.fetch_add(1, std::memory_order_relaxed)} {
       for (ctx_idx_t_ i = 0; i < ThreadCnt; i++) {
-        (*ctxs_)[i].first.store(0, std::memory_order_relaxed);
+        table_->ctxs_[i].first.store(0, std::memory_order_relaxed);
+        table_->in_use_[i].store(true, std::memory_order_relaxed);
       }
     }
 
@@ -194,10 +252,10 @@ namespace SimpleCU::QSBR {
              typename Requires_ = std::enable_if_t<std::is_same_v<std::decay_t<DeleterType_>, DeleterType>>>
     QSBRManager(DeleterType_ &&deleter)
         : DeleterStorage_{std::forward<DeleterType_>(deleter)},
-          ctxs_{std::make_unique<std::array<QSBRContext_, ThreadCnt>>()},
-          mgr_idx_{next_mgr_idx_.fetch_add(1, std::memory_order_relaxed)} {
+          table_{std::make_shared<ContextTable>()}, mgr_idx_{next_mgr_idx_.fetch_add(1, std::memory_order_relaxed)} {
       for (ctx_idx_t_ i = 0; i < ThreadCnt; i++) {
-        (*ctxs_)[i].first.store(0, std::memory_order_relaxed);
+        table_->ctxs_[i].first.store(0, std::memory_order_relaxed);
+        table_->in_use_[i].store(true, std::memory_order_relaxed);
       }
     }
 
@@ -212,67 +270,73 @@ namespace SimpleCU::QSBR {
      */
     ~QSBRManager() {
       for (ctx_idx_t_ i = 0; i < ThreadCnt; i++) {
-        RetiredContext_ &retired_ctx{(*ctxs_)[i].second};
+        RetiredContext_ &retired_ctx{table_->ctxs_[i].second};
         retired_ctx.reclaim(snapshot_full_epochs(), this->get_deleter());
       }
-      tls_map_.erase(mgr_idx_);
+      tls_map_.map_.erase(mgr_idx_);
     }
 
     /**
      * 无论是 `enter` 还是 `exit` 都 Epoch++.
+     * 可以嵌套, 只有最外层的 `enter` / `exit` 改变 Epoch, 内层只记录层数.
      */
     auto enter_critical_zone() -> bool {
-      auto context{get_context()};
-      if (!context.has_value()) {
+      LocalEntry *context{get_context()};
+      if (!context) {
         return false;
       }
-      QSBRContext_ *ctx{context.value().local_qsbr_ctx_};
-      Epoch_ &local_epoch{ctx->first};
-      if ((local_epoch.fetch_add(1, std::memory_order_acquire) & 1ull) == 1) {
-        return false;
+      if (context->depth_++ > 0) {
+        return true;
       }
+      Epoch_ &local_epoch{context->local_qsbr_ctx_->first};
+      local_epoch.fetch_add(1, std::memory_order_acquire);
       return true;
     }
 
     auto exit_critical_zone() -> bool {
-      auto context{get_context()};
-      if (!context.has_value()) {
+      LocalEntry *context{get_context()};
+      if (!context || context->depth_ == 0) {
         return false;
       }
-      QSBRContext_ *ctx{context.value().local_qsbr_ctx_};
-      Epoch_ &local_epoch{ctx->first};
-      if ((local_epoch.fetch_add(1, std::memory_order_release) & 1ull) == 0) {
-        return false;
+      if (--context->depth_ > 0) {
+        return true;
       }
+      Epoch_ &local_epoch{context->local_qsbr_ctx_->first};
+      local_epoch.fetch_add(1, std::memory_order_release);
       return true;
     }
 
     auto get_retired_cnt_local() -> std::uint64_t {
-      auto context{get_context()};
-      if (!context.has_value()) {
+      LocalEntry *context{get_context()};
+      if (!context) {
         return 0;
       }
-      QSBRContext_ *ctx{context.value().local_qsbr_ctx_};
+      QSBRContext_ *ctx{context->local_qsbr_ctx_};
       RetiredContext_ &retired_ctx{ctx->second};
       return retired_ctx.get_cnt();
     }
 
-    void retire(ValType &&val) {
-      auto context{get_context()};
-      if (!context.has_value()) {
-        return;
+    /**
+     * @return 线程上下文已用尽时返回 `false`, `val` 未被接管.
+     */
+    auto retire(ValType &&val) -> bool {
+      LocalEntry *context{get_context()};
+      if (!context) {
+        return false;
       }
-      QSBRContext_ *ctx{context.value().local_qsbr_ctx_};
+      QSBRContext_ *ctx{context->local_qsbr_ctx_};
       RetiredContext_ &retired_ctx{ctx->second};
-      retired_ctx.retire(std::move(val), snapshot_critical_epochs());
+      retired_ctx.retire(std::move(val),
+                         [this](CriticalEpochSnapshot_ &snapshot) { snapshot_critical_epochs(snapshot); });
+      return true;
     }
 
     void reclaim_local() {
-      auto context{get_context()};
-      if (!context.has_value()) {
+      LocalEntry *context{get_context()};
+      if (!context) {
         return;
       }
-      QSBRContext_ *ctx{context.value().local_qsbr_ctx_};
+      QSBRContext_ *ctx{context->local_qsbr_ctx_};
       RetiredContext_ &retired_ctx{ctx->second};
       retired_ctx.reclaim(snapshot_full_epochs(), this->get_deleter());
     }
@@ -281,10 +345,11 @@ namespace SimpleCU::QSBR {
   /**
    * RAII Guard.
    */
-  template<std::size_t ThreadCnt, typename ValType, typename DeleterType>
+  template<std::size_t ThreadCnt, typename ValType, typename DeleterType,
+           Utils::PaddingProfile Profile = Utils::DEFAULT_PADDING>
   class QSBRGuard {
   private:
-    using QSBRManager_ = QSBRManager<ThreadCnt, ValType, DeleterType>;
+    using QSBRManager_ = QSBRManager<ThreadCnt, ValType, DeleterType, Profile>;
     QSBRManager_ *mgr_;
 
   public:
@@ -0,0 +1,384 @@
+#pragma once
+#include "SimpleCU_PerCPU.h"
+#include "SimpleCU_Reclaim.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 读多写少的并发哈希表, 读者无锁, 写者按桶加锁, 扩容渐进进行.
+   *
+   * 每个桶是一条单链表. 节点内容不可变, 修改元素时以新节点替换 (copy-on-write), 被替换或删除的节点 retire.
+   * 读者在读侧保护中遍历链表, 不加锁, 不写任何共享状态.
+   *
+   * 扩容时新建两倍大小的桶数组挂在旧数组的 `next_` 上. 写者每次操作顺带认领一段旧桶迁移: 加锁, 把节点复制到新数组,
+   * 置位 `moved_`, 旧链表整段 retire. 读者和写者遇到已迁移的桶时转到新数组. 最后一段迁移完成的线程切换 `table_`,
+   * 旧桶数组 retire.
+   *
+   * 迁移需要复制节点, 因此键和元素都要求可复制.
+   *
+   * @tparam Key 键类型.
+   * @tparam ValType 元素类型.
+   * @tparam Hash 哈希函数, 结果会再经过一次混合.
+   * @tparam KeyEqual 键的相等比较.
+   * @tparam Reclaimer 节点和桶数组的回收策略, 需要能保护沿 `next` 的遍历, 默认 `Reclaim::QSBRPolicy`.
+   */
+  template<typename Key, typename ValType, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+           typename Reclaimer = Reclaim::QSBRPolicy<>>
+    requires Reclaimer::protects_traversal && std::copy_constructible<Key> && std::copy_constructible<ValType>
+  class RCUHashMap {
+  private:
+    /** 桶的链表长度达到此值时才检查负载因子. */
+    constexpr static std::size_t max_chain{4};
+    /** 每次协助迁移的桶数. */
+    constexpr static std::size_t migrate_chunk{64};
+
+    /**
+     * 节点与桶数组共用一个回收域, 以 `is_table_` 区分.
+     */
+    struct Block {
+      const bool is_table_;
+    };
+
+    struct Node : Block {
+      const std::pair<const Key, ValType> kv_;
+      std::atomic<Node *> next_;
+
+      template<typename... Args>
+      Node(Node *next, Args &&...args) : Block{false}, kv_{std::forward<Args>(args)...}, next_{next} {
+      }
+    };
+
+    struct Bucket {
+      std::atomic<Node *> head_{};
+      std::atomic<bool> moved_{};
+      std::atomic<bool> locked_{};
+
+      void lock() {
+        Utils::ExpBackoff<1, 64, true> backoff{};
+        while (locked_.exchange(true, std::memory_order_acquire)) {
+          while (locked_.load(std::memory_order_relaxed)) {
+            backoff();
+          }
+        }
+      }
+
+      void unlock() {
+        locked_.store(false, std::memory_order_release);
+      }
+    };
+
+    struct Table : Block {
+      const std::size_t mask_;
+      std::unique_ptr<Bucket[]> buckets_;
+      std::atomic<Table *> next_{};
+      Utils::Aligned<std::atomic<std::size_t>> claim_idx_{};
+      Utils::Aligned<std::atomic<std::size_t>> moved_cnt_{};
+
+      explicit Table(std::size_t capacity)
+          : Block{true}, mask_{capacity - 1}, buckets_{std::make_unique<Bucket[]>(capacity)} {
+      }
+
+      auto capacity() const -> std::size_t {
+        return mask_ + 1;
+      }
+
+      auto bucket(std::size_t hash) -> Bucket & {
+        return buckets_[hash & mask_];
+      }
+    };
+
+    /**
+     * 已迁移的旧链表整段 retire, 之后不再修改, 可以沿 `next_` 遍历. 桶数组单独 retire, 其中的链表已各自 retire.
+     */
+    struct NodeOps {
+      static auto next(Block *block) -> Block * {
+        return block->is_table_ ? nullptr : static_cast<Node *>(block)->next_.load(std::memory_order_relaxed);
+      }
+
+      void destroy(Block *block) {
+        if (block->is_table_) {
+          delete static_cast<Table *>(block);
+        } else {
+          delete static_cast<Node *>(block);
+        }
+      }
+    };
+
+    using Domain_ = typename Reclaimer::template Domain<Block, NodeOps>;
+
+    Utils::Aligned<std::atomic<Table *>> table_{};
+    Utils::ShardedCounter size_{};
+    [[no_unique_address]] Hash hasher_;
+    [[no_unique_address]] KeyEqual key_eq_;
+    Domain_ domain_;
+
+    /**
+     * 低位在扩容前后保持一致, 旧桶 `i` 的节点只会迁移到新数组的 `i` 和 `i + capacity`.
+     */
+    auto hash_of(const Key &key) const -> std::size_t {
+      std::uint64_t h{static_cast<std::uint64_t>(hasher_(key)) * 0x9e3779b97f4a7c15ull};
+      return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+
+    /**
+     * 在已加锁的桶中查找, 返回指向匹配节点的链接 (未找到时为链表末尾的空链接) 和链表长度.
+     */
+    auto locate(Bucket &bucket, const Key &key) -> std::pair<std::atomic<Node *> *, std::size_t> {
+      std::atomic<Node *> *link{&bucket.head_};
+      std::size_t len{};
+      for (Node *node = link->load(std::memory_order_relaxed); node; node = link->load(std::memory_order_relaxed)) {
+        if (key_eq_(node->kv_.first, key)) {
+          return {link, len};
+        }
+        link = &node->next_;
+        len++;
+      }
+      return {link, len};
+    }
+
+    /**
+     * 对 `hash` 所在的桶加锁后调用 `fn`. 桶已迁移时转到新数组.
+     */
+    template<typename Fn>
+    auto with_bucket(std::size_t hash, Fn &&fn) {
+      Table *table{table_.load(std::memory_order_acquire)};
+      help_migrate(table);
+      while (true) {
+        Bucket &bucket{table->bucket(hash)};
+        bucket.lock();
+        if (!bucket.moved_.load(std::memory_order_relaxed)) {
+          auto ret{fn(table, bucket)};
+          bucket.unlock();
+          return ret;
+        }
+        bucket.unlock();
+        table = table->next_.load(std::memory_order_acquire);
+      }
+    }
+
+    void migrate_bucket(Table *table, Table *next, std::size_t idx) {
+      Bucket &src{table->buckets_[idx]};
+      src.lock();
+      Node *first{src.head_.load(std::memory_order_relaxed)};
+      Node *last{};
+      for (Node *node = first; node; node = node->next_.load(std::memory_order_relaxed)) {
+        Bucket &dst{next->bucket(hash_of(node->kv_.first))};
+        dst.head_.store(new Node{dst.head_.load(std::memory_order_relaxed), node->kv_}, std::memory_order_relaxed);
+        last = node;
+      }
+      src.moved_.store(true, std::memory_order_release); // 新数组中的链表随之发布
+      src.unlock();
+      if (first) {
+        domain_.retire(first, last);
+      }
+    }
+
+    /**
+     * 迁移中则认领一段旧桶. 迁移最后一段的线程切换 `table_` 并 retire 旧桶数组.
+     */
+    void help_migrate(Table *table) {
+      Table *next{table->next_.load(std::memory_order_acquire)};
+      if (!next || table->claim_idx_.load(std::memory_order_relaxed) >= table->capacity()) {
+        return;
+      }
+      std::size_t beg{table->claim_idx_.fetch_add(migrate_chunk, std::memory_order_relaxed)};
+      if (beg >= table->capacity()) {
+        return;
+      }
+      std::size_t end{std::min(beg + migrate_chunk, table->capacity())};
+      for (std::size_t i = beg; i < end; i++) {
+        migrate_bucket(table, next, i);
+      }
+      if (table->moved_cnt_.fetch_add(end - beg, std::memory_order_acq_rel) + (end - beg) == table->capacity()) {
+        table_.store(next, std::memory_order_release);
+        domain_.retire(table, table);
+      }
+    }
+
+    /**
+     * 负载因子超过 1 且没有进行中的迁移时, 挂上两倍大小的新数组.
+     */
+    void maybe_grow(Table *table) {
+      if (table != table_.load(std::memory_order_acquire) || table->next_.load(std::memory_order_relaxed) ||
+          size_.load() <= static_cast<std::intptr_t>(table->capacity())) {
+        return;
+      }
+      Table *next{new Table{table->capacity() * 2}};
+      Table *expected{};
+      if (!table->next_.compare_exchange_strong(expected, next, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+        delete next;
+      }
+    }
+
+    template<bool Assign, typename... Args>
+    auto put(const Key &key, Args &&...args) -> bool {
+      std::size_t hash{hash_of(key)};
+      auto guard{domain_.guard()};
+      Table *grow{};
+      Node *replaced{};
+      bool inserted{with_bucket(hash, [&](Table *table, Bucket &bucket) {
+        auto [link, len]{locate(bucket, key)};
+        Node *node{link->load(std::memory_order_relaxed)};
+        if (node && !Assign) {
+          return false;
+        }
+        if (len + 1 >= max_chain) {
+          grow = table;
+        }
+        Node *next{node ? node->next_.load(std::memory_order_relaxed) : nullptr};
+        link->store(new Node{next, std::forward<Args>(args)...}, std::memory_order_release);
+        replaced = node;
+        return !node;
+      })};
+      if (replaced) {
+        domain_.retire(replaced, replaced);
+      }
+      if (inserted) {
+        size_.add(1);
+      }
+      if (grow) {
+        maybe_grow(grow);
+      }
+      return inserted;
+    }
+
+    /**
+     * 析构时使用, 释放 `table` 中尚未迁移的桶以及之后的新数组.
+     */
+    static void destroy_table(Table *table) {
+      while (table) {
+        for (std::size_t i = 0; i < table->capacity(); i++) {
+          Bucket &bucket{table->buckets_[i]};
+          if (bucket.moved_.load(std::memory_order_relaxed)) {
+            continue;
+          }
+          for (Node *node = bucket.head_.load(std::memory_order_relaxed); node;) {
+            Node *next{node->next_.load(std::memory_order_relaxed)};
+            delete node;
+            node = next;
+          }
+        }
+        Table *next{table->next_.load(std::memory_order_relaxed)};
+        delete table;
+        table = next;
+      }
+    }
+
+  public:
+    /**
+     * @param capacity 初始桶数, 向上取整为 2 的幂.
+     */
+    explicit RCUHashMap(std::size_t capacity = 16, const Hash &hasher = Hash{}, const KeyEqual &key_eq = KeyEqual{})
+        : hasher_{hasher}, key_eq_{key_eq}, domain_{NodeOps{}} {
+      table_.store(new Table{std::bit_ceil(std::max<std::size_t>(capacity, 2))}, std::memory_order_relaxed);
+    }
+
+    RCUHashMap(const RCUHashMap &) = delete;
+    auto operator=(const RCUHashMap &) -> RCUHashMap & = delete;
+    RCUHashMap(RCUHashMap &&) = delete;
+    auto operator=(RCUHashMap &&) -> RCUHashMap & = delete;
+
+    /**
+     * 析构时不应有其他线程访问. 已 retire 的节点和桶数组由 `domain_` 释放.
+     */
+    ~RCUHashMap() {
+      destroy_table(table_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * 近似值, 只保证最终一致.
+     */
+    auto size() const -> std::size_t {
+      return static_cast<std::size_t>(std::max<std::intptr_t>(size_.load(), 0));
+    }
+
+    /**
+     * 键已存在时不插入.
+     *
+     * @return 是否插入.
+     */
+    auto insert(const Key &key, const ValType &val) -> bool {
+      return put<false>(key, key, val);
+    }
+
+    /**
+     * 键已存在时以新节点替换.
+     *
+     * @return 是否为新插入.
+     */
+    auto insert_or_assign(const Key &key, const ValType &val) -> bool {
+      return put<true>(key, key, val);
+    }
+
+    /**
+     * @return 是否由本次调用删除.
+     */
+    auto erase(const Key &key) -> bool {
+      std::size_t hash{hash_of(key)};
+      auto guard{domain_.guard()};
+      Node *erased{with_bucket(hash, [&](Table *, Bucket &bucket) {
+        std::atomic<Node *> *link{locate(bucket, key).first};
+        Node *node{link->load(std::memory_order_relaxed)};
+        if (node) {
+          link->store(node->next_.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+        return node;
+      })};
+      if (!erased) {
+        return false;
+      }
+      domain_.retire(erased, erased);
+      size_.sub(1);
+      return true;
+    }
+
+    /**
+     * 在读侧保护中以元素的 const 引用调用 `fn`, 不复制元素. `fn` 不应阻塞或再修改本表.
+     *
+     * @return 是否找到.
+     */
+    template<typename Fn>
+    auto visit(const Key &key, Fn &&fn) -> bool {
+      std::size_t hash{hash_of(key)};
+      auto guard{domain_.guard()};
+      Table *table{table_.load(std::memory_order_acquire)};
+      while (true) {
+        Bucket &bucket{table->bucket(hash)};
+        if (!bucket.moved_.load(std::memory_order_acquire)) {
+          Node *node{bucket.head_.load(std::memory_order_acquire)};
+          while (node && !key_eq_(node->kv_.first, key)) {
+            node = node->next_.load(std::memory_order_acquire);
+          }
+          // 遍历期间被迁移时, 之后的写只发生在新数组中, 需要到新数组重新查找
+          if (!bucket.moved_.load(std::memory_order_acquire)) {
+            if (!node) {
+              return false;
+            }
+            std::forward<Fn>(fn)(node->kv_.second);
+            return true;
+          }
+        }
+        table = table->next_.load(std::memory_order_acquire);
+      }
+    }
+
+    auto find(const Key &key) -> std::optional<ValType> {
+      std::optional<ValType> ret{};
+      visit(key, [&ret](const ValType &val) { ret.emplace(val); });
+      return ret;
+    }
+
+    auto contains(const Key &key) -> bool {
+      return visit(key, [](const ValType &) {});
+    }
+
+    auto bucket_cnt() -> std::size_t {
+      auto guard{domain_.guard()};
+      return table_.load(std::memory_order_acquire)->capacity();
+    }
+  };
+
+} // namespace SimpleCU
@@ -0,0 +1,273 @@
+#pragma once
+#include "SimpleCU_HazPtr.h"
+#include "SimpleCU_QSBR.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+/**
+ * 容器使用的回收策略.
+ *
+ * 每个策略提供 `Domain<Node, NodeOps>`, 容器只依赖以下统一接口:
+ * - `auto guard() -> Guard`: 进入读侧保护, `Guard` 析构时退出;
+ * - `Guard::protect(idx, src) -> Node *`: 读取 `src` 并保证返回的节点在 `Guard` 存活期间不被释放;
+ * - `retire(first, last)`: 回收一段已摘下且只经 `NodeOps::next` 相连的节点.
+ *
+ * 线程退出时其上下文交给之后注册的线程. 同时存活的线程超过 `ThreadCnt` 时无法再提供保护, 直接终止进程.
+ *
+ * `NodeOps` 由容器提供:
+ * - `static auto next(Node *) -> Node *`: 节点摘下后其返回值不再改变;
+ * - `void destroy(Node *)`: 析构并归还节点.
+ */
+namespace SimpleCU::Reclaim {
+
+  template<typename Node>
+  struct NodeChain {
+    Node *first_;
+    Node *last_;
+  };
+
+} // namespace SimpleCU::Reclaim
+
+namespace SimpleCU::Reclaim::Details {
+
+  template<typename Node, typename NodeOps>
+  class ChainDeleter : private NodeOps {
+  public:
+    ChainDeleter() = default;
+    ChainDeleter(const NodeOps &ops) : NodeOps{ops} {
+    }
+
+    void operator()(NodeChain<Node> chain) {
+      Node *cur{chain.first_};
+      while (true) {
+        Node *next{NodeOps::next(cur)};
+        bool is_last{cur == chain.last_};
+        NodeOps::destroy(cur);
+        if (is_last) {
+          break;
+        }
+        cur = next;
+      }
+    }
+  };
+
+  /**
+   * 继续执行会访问未受保护的节点或泄漏已摘下的节点.
+   */
+  [[noreturn]] inline void context_exhausted(const char *policy) {
+    std::fprintf(stderr, "SimpleCU::Reclaim::%s: thread contexts exhausted, raise ThreadCnt.\n", policy);
+    std::abort();
+  }
+
+  template<typename Node, typename NodeOps>
+  class NodeDeleter : private NodeOps {
+  public:
+    NodeDeleter() = default;
+    NodeDeleter(const NodeOps &ops) : NodeOps{ops} {
+    }
+
+    void operator()(Node *node) {
+      NodeOps::destroy(node);
+    }
+  };
+
+} // namespace SimpleCU::Reclaim::Details
+
+namespace SimpleCU::Reclaim {
+
+  /**
+   * @brief QSBR 回收策略.
+   *
+   * 读侧为一次临界区进出, `protect` 退化为 acquire load. 整段节点只 retire 一次.
+   * 临界区内可沿 `next` 任意遍历.
+   *
+   * @tparam ThreadCnt 最大线程数.
+   */
+  template<std::size_t ThreadCnt = 64>
+  struct QSBRPolicy {
+    constexpr static bool protects_traversal{true};
+
+    template<typename Node, typename NodeOps>
+    class Domain {
+    private:
+      using Deleter_ = Details::ChainDeleter<Node, NodeOps>;
+      using Manager_ = ::SimpleCU::QSBR::QSBRManager<ThreadCnt, NodeChain<Node>, Deleter_>;
+
+      constexpr static std::uint64_t reclaim_threshold{32};
+
+      Manager_ mgr_;
+
+    public:
+      class Guard {
+      private:
+        Manager_ *mgr_;
+
+      public:
+        Guard(Manager_ &mgr) : mgr_{&mgr} {
+          if (!mgr_->enter_critical_zone()) {
+            Details::context_exhausted("QSBRPolicy");
+          }
+        }
+        Guard(const Guard &) = delete;
+        auto operator=(const Guard &) -> Guard & = delete;
+        Guard(Guard &&that) noexcept : mgr_{std::exchange(that.mgr_, nullptr)} {
+        }
+
+        ~Guard() {
+          if (mgr_) {
+            mgr_->exit_critical_zone();
+          }
+        }
+
+        auto protect(std::size_t, const std::atomic<Node *> &src) -> Node * {
+          return src.load(std::memory_order_acquire);
+        }
+      };
+
+      Domain(const NodeOps &ops) : mgr_{Deleter_{ops}} {
+      }
+
+      auto guard() -> Guard {
+        return Guard{mgr_};
+      }
+
+      /**
+       * 只在本地 retire 数达到不小于阈值的 2 的幂时 reclaim. 有线程长时间停在临界区内时 (如被抢占),
+       * 每次 reclaim 都回收不了, 若每次 retire 都扫描整个列表则总开销为平方级.
+       */
+      void retire(Node *first, Node *last) {
+        if (!mgr_.retire(NodeChain<Node>{first, last})) {
+          Details::context_exhausted("QSBRPolicy");
+        }
+        if (std::uint64_t cnt{mgr_.get_retired_cnt_local()}; cnt >= reclaim_threshold && std::has_single_bit(cnt)) {
+          mgr_.reclaim_local();
+        }
+      }
+    };
+  };
+
+  /**
+   * @brief Hazard Pointer 回收策略.
+   *
+   * 只保护 `protect` 过的节点, 不能沿 `next` 遍历未保护的节点.
+   * 整段节点逐个 retire, 每个节点单独检查 hazard.
+   *
+   * @tparam ThreadCnt 最大线程数.
+   * @tparam SlotCnt 每线程 Hazard Pointer 数量, 即 `protect` 可用的 idx 范围.
+   */
+  template<std::size_t ThreadCnt = 64, std::size_t SlotCnt = 2>
+  struct HazPtrPolicy {
+    constexpr static bool protects_traversal{false};
+
+    template<typename Node, typename NodeOps>
+    class Domain {
+    private:
+      using Deleter_ = Details::NodeDeleter<Node, NodeOps>;
+      using Manager_ = ::SimpleCU::HazPtr::HazPtrManager<Node, ThreadCnt, SlotCnt, Deleter_>;
+
+      Manager_ mgr_;
+
+    public:
+      class Guard {
+      private:
+        Manager_ *mgr_;
+        std::uint32_t used_{};
+
+      public:
+        Guard(Manager_ &mgr) : mgr_{&mgr} {
+        }
+        Guard(const Guard &) = delete;
+        auto operator=(const Guard &) -> Guard & = delete;
+        Guard(Guard &&that) noexcept : mgr_{std::exchange(that.mgr_, nullptr)}, used_{that.used_} {
+        }
+
+        ~Guard() {
+          if (!mgr_) {
+            return;
+          }
+          for (std::size_t i = 0; i < SlotCnt; i++) {
+            if (used_ & (1u << i)) {
+              mgr_->unset_hazptr(i); // release
+            }
+          }
+        }
+
+        /**
+         * (1) seq_cst store 保证不和 (2) 乱序, (2) 必须读到最新值来确认 `src` 在设置期间没有变化,
+         * 否则节点可能早在设置 hazard pointer 之前就已被回收.
+         */
+        auto protect(std::size_t idx, const std::atomic<Node *> &src) -> Node * {
+          used_ |= 1u << idx;
+          Node *ptr{src.load(std::memory_order_relaxed)};
+          Node *tmp{};
+          do {
+            tmp = ptr;
+            if (!mgr_->set_hazptr(idx, ptr)) { // (1)
+              Details::context_exhausted("HazPtrPolicy");
+            }
+            ptr = src.load(std::memory_order_seq_cst); // (2)
+          } while (ptr != tmp);
+          return ptr;
+        }
+      };
+
+      Domain(const NodeOps &ops) : mgr_{Deleter_{ops}} {
+      }
+
+      auto guard() -> Guard {
+        return Guard{mgr_};
+      }
+
+      void retire(Node *first, Node *last) {
+        Node *cur{first};
+        while (true) {
+          Node *next{NodeOps::next(cur)};
+          bool is_last{cur == last};
+          if (!mgr_.retire(cur)) {
+            Details::context_exhausted("HazPtrPolicy");
+          }
+          if (is_last) {
+            break;
+          }
+          cur = next;
+        }
+        if (mgr_.get_retired_cnt_local() >= 2 * mgr_.get_max_hazptr_cnt_global()) {
+          mgr_.reclaim_local();
+        }
+      }
+    };
+  };
+
+  /**
+   * @brief 不回收策略.
+   *
+   * 摘下的节点不再归还, 读侧没有任何开销.
+   * 配合 arena 式的 Allocator 使用 (如 `std::pmr::polymorphic_allocator` + `std::pmr::synchronized_pool_resource`),
+   * 由 Allocator 的生命周期统一释放内存. 与 `std::allocator` 搭配会泄漏.
+   */
+  struct LeakPolicy {
+    constexpr static bool protects_traversal{true};
+
+    template<typename Node, typename NodeOps>
+    class Domain {
+    public:
+      class Guard {
+      public:
+        auto protect(std::size_t, const std::atomic<Node *> &src) -> Node * {
+          return src.load(std::memory_order_acquire);
+        }
+      };
+
+      Domain(const NodeOps &) {
+      }
+
+      auto guard() -> Guard {
+        return Guard{};
+      }
+
+      void retire(Node *, Node *) {
+      }
+    };
+  };
+
+} // namespace SimpleCU::Reclaim
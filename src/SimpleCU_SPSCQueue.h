@@ -0,0 +1,182 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 单生产者单消费者的定容量环形队列, 两端都是 wait-free.
+   *
+   * `tail_` 只由生产者写, `head_` 只由消费者写, 不需要 CAS. 每一端还缓存了对端的下标,
+   * 只有按缓存判断为满 / 空时才重新读取对端所在的 cacheline, 稳态下两端各自只访问本地的 cacheline.
+   *
+   * 批量接口和 `reserve` / `commit` 对多个槽位只发布一次, 摊薄 release store 与 cacheline 迁移.
+   *
+   * @tparam ValType 元素类型.
+   */
+  template<typename ValType>
+  class SPSCQueue {
+  private:
+    struct Producer {
+      std::atomic<std::size_t> tail_{};
+      std::size_t cached_head_{};
+    };
+
+    struct Consumer {
+      std::atomic<std::size_t> head_{};
+      std::size_t cached_tail_{};
+    };
+
+    const std::size_t mask_;
+    ValType *slots_;
+    Utils::Aligned<Producer> producer_{};
+    Utils::Aligned<Consumer> consumer_{};
+
+    /**
+     * 生产者可写的槽位数, 缓存不足 `want` 时才读取 `head_`.
+     */
+    auto writable(std::size_t tail, std::size_t want) -> std::size_t {
+      std::size_t free{capacity() - (tail - producer_.cached_head_)};
+      if (free < want) {
+        producer_.cached_head_ = consumer_.head_.load(std::memory_order_acquire);
+        free = capacity() - (tail - producer_.cached_head_);
+      }
+      return free;
+    }
+
+    /**
+     * 消费者可读的元素数, 缓存不足 `want` 时才读取 `tail_`.
+     */
+    auto readable(std::size_t head, std::size_t want) -> std::size_t {
+      std::size_t avail{consumer_.cached_tail_ - head};
+      if (avail < want) {
+        consumer_.cached_tail_ = producer_.tail_.load(std::memory_order_acquire);
+        avail = consumer_.cached_tail_ - head;
+      }
+      return avail;
+    }
+
+  public:
+    /**
+     * @param capacity 向上取整为 2 的幂.
+     */
+    explicit SPSCQueue(std::size_t capacity)
+        : mask_{std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1},
+          slots_{std::allocator<ValType>{}.allocate(mask_ + 1)} {
+    }
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    auto operator=(const SPSCQueue &) -> SPSCQueue & = delete;
+    SPSCQueue(SPSCQueue &&) = delete;
+    auto operator=(SPSCQueue &&) -> SPSCQueue & = delete;
+
+    ~SPSCQueue() {
+      std::size_t tail{producer_.tail_.load(std::memory_order_relaxed)};
+      for (std::size_t pos = consumer_.head_.load(std::memory_order_relaxed); pos != tail; pos++) {
+        std::destroy_at(&slots_[pos & mask_]);
+      }
+      std::allocator<ValType>{}.deallocate(slots_, mask_ + 1);
+    }
+
+    auto capacity() const -> std::size_t {
+      return mask_ + 1;
+    }
+
+    /**
+     * 仅生产者调用.
+     * @return 队列满时返回 `false`.
+     */
+    template<typename... Args>
+    auto try_emplace(Args &&...args) -> bool {
+      std::size_t tail{producer_.tail_.load(std::memory_order_relaxed)};
+      if (writable(tail, 1) == 0) {
+        return false;
+      }
+      std::construct_at(&slots_[tail & mask_], std::forward<Args>(args)...);
+      producer_.tail_.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    auto try_push(const ValType &val) -> bool {
+      return try_emplace(val);
+    }
+
+    auto try_push(ValType &&val) -> bool {
+      return try_emplace(std::move(val));
+    }
+
+    /**
+     * 仅消费者调用.
+     */
+    auto try_pop() -> std::optional<ValType> {
+      std::size_t head{consumer_.head_.load(std::memory_order_relaxed)};
+      if (readable(head, 1) == 0) {
+        return std::nullopt;
+      }
+      ValType &slot{slots_[head & mask_]};
+      std::optional<ValType> ret{std::move(slot)};
+      std::destroy_at(&slot);
+      consumer_.head_.store(head + 1, std::memory_order_release);
+      return ret;
+    }
+
+    /**
+     * 仅生产者调用, 写入 `[first, last)` 中能放下的前缀, 只发布一次.
+     * @return 写入的元素个数.
+     */
+    template<typename ForwardIt>
+    auto try_push_bulk(ForwardIt first, ForwardIt last) -> std::size_t {
+      std::size_t want{static_cast<std::size_t>(std::distance(first, last))};
+      std::size_t tail{producer_.tail_.load(std::memory_order_relaxed)};
+      std::size_t cnt{std::min(want, writable(tail, want))};
+      for (std::size_t i = 0; i < cnt; i++, ++first) {
+        std::construct_at(&slots_[(tail + i) & mask_], *first);
+      }
+      if (cnt != 0) {
+        producer_.tail_.store(tail + cnt, std::memory_order_release);
+      }
+      return cnt;
+    }
+
+    /**
+     * 仅消费者调用, 至多读出 `max_cnt` 个元素写入 `out`, 只发布一次.
+     * @return 读出的元素个数.
+     */
+    template<typename OutputIt>
+    auto try_pop_bulk(OutputIt out, std::size_t max_cnt) -> std::size_t {
+      std::size_t head{consumer_.head_.load(std::memory_order_relaxed)};
+      std::size_t cnt{std::min(max_cnt, readable(head, max_cnt))};
+      for (std::size_t i = 0; i < cnt; i++) {
+        ValType &slot{slots_[(head + i) & mask_]};
+        *out++ = std::move(slot);
+        std::destroy_at(&slot);
+      }
+      if (cnt != 0) {
+        consumer_.head_.store(head + cnt, std::memory_order_release);
+      }
+      return cnt;
+    }
+
+    /**
+     * 仅生产者调用, 返回环中连续的至多 `max_cnt` 个空闲槽位, 调用方直接写入后以 `commit` 发布.
+     * 跨越环尾时只返回到环尾的部分. 槽位未经构造, 因此要求元素可平凡复制.
+     */
+    auto reserve(std::size_t max_cnt) -> std::span<ValType>
+      requires std::is_trivially_copyable_v<ValType>
+    {
+      std::size_t tail{producer_.tail_.load(std::memory_order_relaxed)};
+      std::size_t cnt{std::min({max_cnt, writable(tail, max_cnt), capacity() - (tail & mask_)})};
+      return {&slots_[tail & mask_], cnt};
+    }
+
+    /**
+     * 发布 `reserve` 返回的前 `cnt` 个槽位.
+     */
+    void commit(std::size_t cnt)
+      requires std::is_trivially_copyable_v<ValType>
+    {
+      producer_.tail_.store(producer_.tail_.load(std::memory_order_relaxed) + cnt, std::memory_order_release);
+    }
+  };
+
+} // namespace SimpleCU
@@ -0,0 +1,501 @@
+#pragma once
+#include "SimpleCU_EventCount.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 放在 `memfd_create` + `mmap` 共享内存中的定容量 MPMC 环形队列, 供同一主机上的多个进程通信.
+   *
+   * 算法与 `BoundedQueue` 相同 (每个槽位带序号), 共享区中只有偏移和序号, 没有指针, 各进程映射到任意地址都可使用.
+   * 元素在共享区中原地读写 (`try_push_with` / `try_pop_with`), 不经过内核. 队列满 / 空时阻塞的
+   * `push_with` / `pop_with` 在共享区的 futex 上睡眠, 通知方只在确实有等待者时才进入内核.
+   *
+   * 每个线程通过 `Endpoint` 操作队列. `Endpoint` 在共享区登记所属进程的 pid, 并在认领位置前记录该位置.
+   * 进程在认领之后、完成之前崩溃时, 对应槽位会卡住整个队列. `recover` 找出 pid 已不存在的 `Endpoint`:
+   * - 生产者: 把槽位标为作废并发布, 消费者跳过;
+   * - 消费者: 直接释放槽位, 该元素丢失.
+   * 该位置同时被存活的 `Endpoint` 记录时 (其 CAS 将失败或尚未完成), 本次不处理, 留待下次 `recover`.
+   * 睡眠中崩溃的 `Endpoint` 留下的等待者计数也一并撤销, 否则之后每次通知都会进入内核.
+   * `attach` 时和阻塞等待超时时自动调用 `recover`, 崩溃的进程重启后重新 `attach` 即可继续使用.
+   *
+   * 以 pid 判断进程是否存活, 不处理 pid 复用.
+   *
+   * @tparam ValType 元素类型, 跨进程按字节共享, 要求可平凡复制.
+   */
+  template<typename ValType>
+    requires std::is_trivially_copyable_v<ValType>
+  class ShmQueue {
+  private:
+    constexpr static std::uint64_t magic{0x53434d5148554551ull};
+    constexpr static std::uint32_t version{2};
+    constexpr static std::size_t max_endpoint_cnt{64};
+    constexpr static std::uint64_t claim_valid{2};
+    constexpr static std::uint64_t claim_consumer{1};
+    constexpr static std::uint64_t seq_poisoned{1ull << 63};
+    constexpr static std::uint32_t wait_not_empty{1};
+    constexpr static std::uint32_t wait_not_full{2};
+    constexpr static std::size_t spin_cnt{128};
+    constexpr static auto recover_interval{std::chrono::milliseconds{100}};
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared atomics must be address-free.");
+
+    /**
+     * `seq_` 的最高位表示槽位由 `recover` 发布, 不含有效元素.
+     */
+    struct Slot {
+      std::atomic<std::uint64_t> seq_;
+      alignas(ValType) std::byte storage_[sizeof(ValType)];
+
+      auto val() -> ValType * {
+        return std::launder(reinterpret_cast<ValType *>(storage_));
+      }
+    };
+
+    /**
+     * `claim_` 为 `pos << 2 | claim_valid | 角色`, 0 表示没有进行中的认领.
+     * `waiting_` 为正在等待的 `EventCount` (`wait_not_empty` / `wait_not_full`), 0 表示没有计入等待者.
+     * 它在 `prepare_wait` 之后置位, 在撤销计数之前清除, 崩溃时最多多计一个等待者, 不会重复撤销.
+     */
+    struct EndpointRecord {
+      std::atomic<std::int32_t> pid_;
+      std::atomic<std::uint32_t> waiting_;
+      std::atomic<std::uint64_t> claim_;
+    };
+
+    /**
+     * 共享区开头, 槽位数组位于 `slots_offset_` 处. `magic_` 最后写入, 作为初始化完成的标志.
+     */
+    struct Header {
+      std::atomic<std::uint64_t> magic_;
+      std::uint32_t version_;
+      std::uint32_t slot_size_;
+      std::uint64_t capacity_;
+      std::uint64_t slots_offset_;
+      std::uint64_t map_size_;
+      Utils::Aligned<std::atomic<std::uint64_t>> tail_;
+      Utils::Aligned<std::atomic<std::uint64_t>> head_;
+      Utils::BasicEventCount<true> not_empty_;
+      Utils::BasicEventCount<true> not_full_;
+      std::array<EndpointRecord, max_endpoint_cnt> endpoints_;
+    };
+
+    using diff_t_ = std::int64_t;
+
+    int fd_{-1};
+    std::byte *base_{};
+    std::size_t map_size_{};
+
+    ShmQueue(int fd, std::byte *base, std::size_t map_size) : fd_{fd}, base_{base}, map_size_{map_size} {
+    }
+
+    auto header() -> Header & {
+      return *std::launder(reinterpret_cast<Header *>(base_));
+    }
+
+    auto slot_at(std::uint64_t pos) -> Slot & {
+      Header &hdr{header()};
+      return std::launder(reinterpret_cast<Slot *>(base_ + hdr.slots_offset_))[pos & (hdr.capacity_ - 1)];
+    }
+
+    static auto slots_offset() -> std::size_t {
+      return (sizeof(Header) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+    }
+
+    static auto encode_claim(std::uint64_t pos, bool consumer) -> std::uint64_t {
+      return pos << 2 | claim_valid | (consumer ? claim_consumer : 0);
+    }
+
+    static auto is_alive(std::int32_t pid) -> bool {
+      return ::kill(pid, 0) == 0 || errno != ESRCH;
+    }
+
+    static auto map(int fd, std::size_t size) -> std::byte * {
+      void *addr{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+      return addr == MAP_FAILED ? nullptr : static_cast<std::byte *>(addr);
+    }
+
+    auto register_endpoint() -> std::optional<std::size_t> {
+      std::int32_t pid{static_cast<std::int32_t>(::getpid())};
+      for (std::size_t round = 0; round < 2; round++) {
+        for (std::size_t i = 0; i < max_endpoint_cnt; i++) {
+          std::int32_t expected{};
+          if (header().endpoints_[i].pid_.compare_exchange_strong(expected, pid, std::memory_order_acq_rel,
+                                                                  std::memory_order_relaxed)) {
+            return i;
+          }
+        }
+        recover();
+      }
+      return std::nullopt;
+    }
+
+    void unregister_endpoint(std::size_t idx) {
+      EndpointRecord &rec{header().endpoints_[idx]};
+      rec.claim_.store(0, std::memory_order_relaxed);
+      rec.waiting_.store(0, std::memory_order_relaxed);
+      rec.pid_.store(0, std::memory_order_release);
+    }
+
+    /**
+     * 须在确认 `tail_` / `head_` 已越过该位置之后调用, 此时认领成功者的记录一定可见.
+     */
+    auto claimed_by_live(std::size_t self, std::uint64_t claim) -> bool {
+      for (std::size_t i = 0; i < max_endpoint_cnt; i++) {
+        EndpointRecord &rec{header().endpoints_[i]};
+        std::int32_t pid{rec.pid_.load(std::memory_order_acquire)};
+        if (i != self && pid != 0 && rec.claim_.load(std::memory_order_acquire) == claim && is_alive(pid)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /**
+     * 完成已崩溃的 `Endpoint` 认领的位置. 槽位序号用 CAS 推进, 多个进程同时 `recover` 也只生效一次.
+     * 位置未被认领成功时无需处理.
+     *
+     * @return 该位置同时被存活的 `Endpoint` 记录, 无法判断由谁认领时返回 `false`.
+     */
+    auto complete_claim(std::size_t self, std::uint64_t claim) -> bool {
+      Header &hdr{header()};
+      std::uint64_t pos{claim >> 2};
+      bool consumer{(claim & claim_consumer) != 0};
+      if ((consumer ? hdr.head_ : hdr.tail_).load(std::memory_order_acquire) <= pos) {
+        return true;
+      }
+      if (claimed_by_live(self, claim)) {
+        return false;
+      }
+      Slot &slot{slot_at(pos)};
+      if (!consumer) {
+        std::uint64_t expected{pos};
+        if (slot.seq_.compare_exchange_strong(expected, (pos + 1) | seq_poisoned, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+          hdr.not_empty_.notify_all();
+        }
+      } else {
+        std::uint64_t expected{slot.seq_.load(std::memory_order_relaxed)};
+        if ((expected & ~seq_poisoned) == pos + 1 &&
+            slot.seq_.compare_exchange_strong(expected, pos + hdr.capacity_, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+          hdr.not_full_.notify_all();
+        }
+      }
+      return true;
+    }
+
+    auto event_count(std::uint32_t waiting) -> Utils::BasicEventCount<true> & {
+      return waiting == wait_not_empty ? header().not_empty_ : header().not_full_;
+    }
+
+    /**
+     * 认领一个位置, 认领前先记录到 `rec`. 已满 / 已空时返回 `std::nullopt`.
+     */
+    template<bool Consumer>
+    auto claim(EndpointRecord &rec) -> std::optional<std::uint64_t> {
+      Header &hdr{header()};
+      auto &pos_{Consumer ? hdr.head_ : hdr.tail_};
+      std::uint64_t pos{pos_.load(std::memory_order_relaxed)};
+      while (true) {
+        rec.claim_.store(encode_claim(pos, Consumer), std::memory_order_relaxed);
+        std::uint64_t seq{slot_at(pos).seq_.load(std::memory_order_acquire) & ~seq_poisoned};
+        diff_t_ diff{static_cast<diff_t_>(seq - (pos + (Consumer ? 1 : 0)))};
+        if (diff == 0) {
+          // release: 观察到 `pos_` 已越过 `pos` 的 `recover` 一定能看到上面的记录
+          if (pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return pos;
+          }
+        } else if (diff < 0) {
+          rec.claim_.store(0, std::memory_order_relaxed);
+          return std::nullopt;
+        } else {
+          pos = pos_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+  public:
+    /**
+     * @brief 一个线程操作队列的句柄, 不可跨线程同时使用.
+     *
+     * 生存期内所属的 `ShmQueue` 不能被移动或析构.
+     */
+    class Endpoint {
+    private:
+      friend class ShmQueue;
+
+      ShmQueue *queue_;
+      std::size_t idx_;
+
+      Endpoint(ShmQueue *queue, std::size_t idx) : queue_{queue}, idx_{idx} {
+      }
+
+      auto record() -> EndpointRecord & {
+        return queue_->header().endpoints_[idx_];
+      }
+
+      /**
+       * 先自旋 `spin_cnt` 次, 再在共享区的 futex 上睡眠, 每 `recover_interval` 醒来一次 `recover`.
+       * 睡眠期间在 `record()` 中登记, 供 `recover` 撤销崩溃时遗留的等待者计数.
+       */
+      template<typename Fn>
+      void block_until(std::uint32_t waiting, Fn &&attempt) {
+        for (std::size_t i = 0; i < spin_cnt; i++) {
+          if (attempt()) {
+            return;
+          }
+          Utils::cpu_relax();
+        }
+        Utils::BasicEventCount<true> &ec{queue_->event_count(waiting)};
+        EndpointRecord &rec{record()};
+        while (!attempt()) {
+          auto key{ec.prepare_wait()};
+          rec.waiting_.store(waiting, std::memory_order_release);
+          bool done{attempt()};
+          bool notified{done || ec.sleep_until(key, std::chrono::steady_clock::now() + recover_interval)};
+          rec.waiting_.store(0, std::memory_order_release);
+          ec.cancel_wait();
+          if (done) {
+            return;
+          }
+          if (!notified) {
+            queue_->recover();
+          }
+        }
+      }
+
+    public:
+      Endpoint(const Endpoint &) = delete;
+      auto operator=(const Endpoint &) -> Endpoint & = delete;
+      Endpoint(Endpoint &&that) noexcept : queue_{std::exchange(that.queue_, nullptr)}, idx_{that.idx_} {
+      }
+      auto operator=(Endpoint &&) -> Endpoint & = delete;
+
+      ~Endpoint() {
+        if (queue_) {
+          queue_->unregister_endpoint(idx_);
+        }
+      }
+
+      /**
+       * 以 `fill` 在共享区中原地写入元素.
+       *
+       * @return 已满返回 `false`, 此时不调用 `fill`.
+       */
+      template<typename Fn>
+      auto try_push_with(Fn &&fill) -> bool {
+        std::optional<std::uint64_t> pos{queue_->template claim<false>(record())};
+        if (!pos.has_value()) {
+          return false;
+        }
+        Slot &slot{queue_->slot_at(pos.value())};
+        std::forward<Fn>(fill)(*slot.val());
+        slot.seq_.store(pos.value() + 1, std::memory_order_release);
+        record().claim_.store(0, std::memory_order_release);
+        queue_->header().not_empty_.notify_one();
+        return true;
+      }
+
+      /**
+       * 以 `consume` 在共享区中原地读取元素, 返回后槽位即被复用. 跳过被 `recover` 作废的槽位.
+       *
+       * @return 已空返回 `false`, 此时不调用 `consume`.
+       */
+      template<typename Fn>
+      auto try_pop_with(Fn &&consume) -> bool {
+        Header &hdr{queue_->header()};
+        while (true) {
+          std::optional<std::uint64_t> pos{queue_->template claim<true>(record())};
+          if (!pos.has_value()) {
+            return false;
+          }
+          Slot &slot{queue_->slot_at(pos.value())};
+          bool poisoned{(slot.seq_.load(std::memory_order_relaxed) & seq_poisoned) != 0};
+          if (!poisoned) {
+            std::forward<Fn>(consume)(std::as_const(*slot.val()));
+          }
+          slot.seq_.store(pos.value() + hdr.capacity_, std::memory_order_release);
+          record().claim_.store(0, std::memory_order_release);
+          hdr.not_full_.notify_one();
+          if (!poisoned) {
+            return true;
+          }
+        }
+      }
+
+      auto try_push(const ValType &val) -> bool {
+        return try_push_with([&val](ValType &slot) { std::memcpy(&slot, &val, sizeof(ValType)); });
+      }
+
+      auto try_pop() -> std::optional<ValType> {
+        std::optional<ValType> ret{};
+        try_pop_with([&ret](const ValType &slot) { ret.emplace(slot); });
+        return ret;
+      }
+
+      /**
+       * 已满时阻塞, 见 `block_until`.
+       */
+      template<typename Fn>
+      void push_with(Fn &&fill) {
+        block_until(wait_not_full, [this, &fill]() { return try_push_with(fill); });
+      }
+
+      template<typename Fn>
+      void pop_with(Fn &&consume) {
+        block_until(wait_not_empty, [this, &consume]() { return try_pop_with(consume); });
+      }
+
+      void push(const ValType &val) {
+        push_with([&val](ValType &slot) { std::memcpy(&slot, &val, sizeof(ValType)); });
+      }
+
+      auto pop() -> ValType {
+        std::optional<ValType> ret{};
+        pop_with([&ret](const ValType &slot) { ret.emplace(slot); });
+        return ret.value();
+      }
+    };
+
+    /**
+     * 新建共享区. 返回的队列持有 memfd, 可经 `fd()` 以 fork 继承或 `SCM_RIGHTS` 传给其他进程后 `attach`.
+     *
+     * @param capacity 向上取整为 2 的幂.
+     */
+    static auto create(const char *name, std::size_t capacity) -> std::optional<ShmQueue> {
+      capacity = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+      std::size_t map_size{slots_offset() + capacity * sizeof(Slot)};
+      int fd{::memfd_create(name, 0)};
+      if (fd < 0) {
+        return std::nullopt;
+      }
+      std::byte *base{};
+      if (::ftruncate(fd, static_cast<off_t>(map_size)) != 0 || !(base = map(fd, map_size))) {
+        ::close(fd);
+        return std::nullopt;
+      }
+      Header *hdr{std::construct_at(reinterpret_cast<Header *>(base))};
+      hdr->version_ = version;
+      hdr->slot_size_ = sizeof(ValType);
+      hdr->capacity_ = capacity;
+      hdr->slots_offset_ = slots_offset();
+      hdr->map_size_ = map_size;
+      Slot *slots{reinterpret_cast<Slot *>(base + slots_offset())};
+      for (std::size_t i = 0; i < capacity; i++) {
+        std::construct_at(&slots[i].seq_, i);
+      }
+      hdr->magic_.store(magic, std::memory_order_release);
+      return ShmQueue{fd, base, map_size};
+    }
+
+    /**
+     * 映射其他进程创建的共享区并校验布局, 之后回收已崩溃进程的 `Endpoint`. 内部 `dup` 一份 `fd`.
+     */
+    static auto attach(int fd) -> std::optional<ShmQueue> {
+      struct stat st{};
+      if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        return std::nullopt;
+      }
+      std::size_t map_size{static_cast<std::size_t>(st.st_size)};
+      int own_fd{::dup(fd)};
+      std::byte *base{own_fd < 0 ? nullptr : map(own_fd, map_size)};
+      if (!base) {
+        if (own_fd >= 0) {
+          ::close(own_fd);
+        }
+        return std::nullopt;
+      }
+      ShmQueue queue{own_fd, base, map_size};
+      Header &hdr{queue.header()};
+      if (hdr.magic_.load(std::memory_order_acquire) != magic || hdr.version_ != version ||
+          hdr.slot_size_ != sizeof(ValType) || hdr.map_size_ != map_size || !std::has_single_bit(hdr.capacity_) ||
+          hdr.slots_offset_ != slots_offset()) {
+        return std::nullopt;
+      }
+      queue.recover();
+      return queue;
+    }
+
+    ShmQueue(const ShmQueue &) = delete;
+    auto operator=(const ShmQueue &) -> ShmQueue & = delete;
+    ShmQueue(ShmQueue &&that) noexcept
+        : fd_{std::exchange(that.fd_, -1)}, base_{std::exchange(that.base_, nullptr)},
+          map_size_{std::exchange(that.map_size_, 0)} {
+    }
+    auto operator=(ShmQueue &&) -> ShmQueue & = delete;
+
+    /**
+     * 只解除本进程的映射, 共享区在所有映射和 fd 都关闭后由内核释放.
+     */
+    ~ShmQueue() {
+      if (base_) {
+        ::munmap(base_, map_size_);
+      }
+      if (fd_ >= 0) {
+        ::close(fd_);
+      }
+    }
+
+    auto fd() const -> int {
+      return fd_;
+    }
+
+    auto capacity() -> std::size_t {
+      return header().capacity_;
+    }
+
+    /**
+     * 两个 `EventCount` 上的等待者总数, 只是快照.
+     */
+    auto waiter_cnt() -> std::size_t {
+      return header().not_empty_.waiter_cnt() + header().not_full_.waiter_cnt();
+    }
+
+    /**
+     * 登记失败 (已有 `max_endpoint_cnt` 个存活的 `Endpoint`) 时返回 `std::nullopt`.
+     */
+    auto endpoint() -> std::optional<Endpoint> {
+      std::optional<std::size_t> idx{register_endpoint()};
+      if (!idx.has_value()) {
+        return std::nullopt;
+      }
+      return Endpoint{this, idx.value()};
+    }
+
+    /**
+     * 回收 pid 已不存在的 `Endpoint`, 撤销其等待者计数并完成其认领的位置.
+     *
+     * @return 回收的数量.
+     */
+    auto recover() -> std::size_t {
+      std::int32_t self_pid{static_cast<std::int32_t>(::getpid())};
+      std::size_t cnt{};
+      for (std::size_t i = 0; i < max_endpoint_cnt; i++) {
+        EndpointRecord &rec{header().endpoints_[i]};
+        std::int32_t pid{rec.pid_.load(std::memory_order_acquire)};
+        // 先以本进程的 pid 接管记录, 同一记录只由一个进程处理; 处理中途崩溃则由下一次 recover 接着处理
+        if (pid == 0 || is_alive(pid) ||
+            !rec.pid_.compare_exchange_strong(pid, self_pid, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+          continue;
+        }
+        if (std::uint32_t waiting{rec.waiting_.exchange(0, std::memory_order_acq_rel)}; waiting != 0) {
+          event_count(waiting).cancel_wait();
+        }
+        if (std::uint64_t claim{rec.claim_.load(std::memory_order_acquire)}; claim != 0 && !complete_claim(i, claim)) {
+          rec.pid_.store(pid, std::memory_order_release);
+          continue;
+        }
+        unregister_endpoint(i);
+        cnt++;
+      }
+      return cnt;
+    }
+  };
+
+} // namespace SimpleCU
@@ -0,0 +1,453 @@
+#pragma once
+#include "SimpleCU_Reclaim.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 基于无锁跳表的有序 map (Fraser / Herlihy-Shavit).
+   *
+   * 每层 `next` 的最低位为删除标记, 标记置位后该层指针不再改变. `erase` 自顶向下标记各层,
+   * 第 0 层 `fetch_or` 成功者为删除者. 写操作查找时顺带以 CAS 摘除经过的已标记节点.
+   *
+   * `find` / `contains` / `lower_bound` / `range` 只读不写, 越过已标记节点而不摘除, 不会失败重试.
+   * `Range` 持有读侧保护, 迭代期间经过的节点不会被释放. 迭代是弱一致的:
+   * 迭代全程都存在的键恰好按序出现一次, 迭代期间插入或删除的键可能出现也可能不出现.
+   *
+   * 插入方可能在删除方摘除之后才链接高层指针, 因此两者各自完成后递增 `finish_cnt_`,
+   * 后到者再查找一次摘除该节点并 retire.
+   *
+   * 元素插入后不再修改.
+   *
+   * @tparam Key 键类型.
+   * @tparam ValType 元素类型.
+   * @tparam Compare 键的严格弱序.
+   * @tparam Reclaimer 节点的回收策略, 需要能保护沿 `next` 的遍历, 默认 `Reclaim::QSBRPolicy`.
+   */
+  template<typename Key, typename ValType, typename Compare = std::less<Key>,
+           typename Reclaimer = Reclaim::QSBRPolicy<>>
+    requires Reclaimer::protects_traversal
+  class SkipListMap {
+  public:
+    using value_type = std::pair<const Key, ValType>;
+
+  private:
+    using link_t_ = std::uintptr_t;
+
+    constexpr static std::uint32_t max_level{24};
+    constexpr static link_t_ mark_bit{1};
+
+    /**
+     * 头节点不构造元素. `level_` 个 `next` 指针紧随节点之后分配.
+     */
+    struct alignas(std::atomic<link_t_>) Node {
+      const std::uint32_t level_;
+      std::atomic<std::uint32_t> finish_cnt_{};
+      alignas(value_type) std::byte kv_[sizeof(value_type)];
+
+      explicit Node(std::uint32_t level) : level_{level} {
+      }
+
+      auto kv() -> value_type & {
+        return *std::launder(reinterpret_cast<value_type *>(kv_));
+      }
+
+      auto key() -> const Key & {
+        return kv().first;
+      }
+
+      auto next(std::uint32_t i) -> std::atomic<link_t_> & {
+        return std::launder(reinterpret_cast<std::atomic<link_t_> *>(this + 1))[i];
+      }
+    };
+
+    /**
+     * 节点逐个 retire, 不成链.
+     */
+    struct NodeOps {
+      static auto next(Node *) -> Node * {
+        return nullptr;
+      }
+
+      void destroy(Node *node) {
+        destroy_node(node);
+      }
+    };
+
+    using Domain_ = typename Reclaimer::template Domain<Node, NodeOps>;
+    using Guard_ = typename Domain_::Guard;
+    using Preds_ = std::array<Node *, max_level>;
+
+    Node *head_;
+    [[no_unique_address]] Compare comp_;
+    Domain_ domain_;
+
+    static auto is_marked(link_t_ link) -> bool {
+      return (link & mark_bit) != 0;
+    }
+
+    static auto to_node(link_t_ link) -> Node * {
+      return reinterpret_cast<Node *>(link & ~mark_bit);
+    }
+
+    static auto to_link(Node *node) -> link_t_ {
+      return reinterpret_cast<link_t_>(node);
+    }
+
+    static auto alloc_size(std::uint32_t level) -> std::size_t {
+      return sizeof(Node) + level * sizeof(std::atomic<link_t_>);
+    }
+
+    static auto random_level() -> std::uint32_t {
+      return std::min<std::uint32_t>(std::countr_one(Utils::fast_random()) + 1, max_level);
+    }
+
+    static auto create_node(std::uint32_t level) -> Node * {
+      void *mem{::operator new(alloc_size(level), std::align_val_t{alignof(Node)})};
+      Node *node{std::construct_at(static_cast<Node *>(mem), level)};
+      for (std::uint32_t i = 0; i < level; i++) {
+        std::construct_at(&node->next(i), link_t_{});
+      }
+      return node;
+    }
+
+    static void free_node(Node *node) {
+      std::uint32_t level{node->level_};
+      std::destroy_at(node);
+      ::operator delete(static_cast<void *>(node), alloc_size(level), std::align_val_t{alignof(Node)});
+    }
+
+    static void destroy_node(Node *node) {
+      std::destroy_at(&node->kv());
+      free_node(node);
+    }
+
+    auto is_less(Node *node, const Key &key) const -> bool {
+      return comp_(node->key(), key);
+    }
+
+    auto is_equal(Node *node, const Key &key) const -> bool {
+      return node && !comp_(key, node->key()) && !comp_(node->key(), key);
+    }
+
+    /**
+     * 找到每层最后一个键小于 `key` 的未标记节点及其后继, 摘除途经的已标记节点. 摘除失败时从头重新查找.
+     *
+     * @return 第 0 层的后继的键是否等于 `key`.
+     */
+    auto find_preds(const Key &key, Preds_ &preds, Preds_ &succs) -> bool {
+    retry:
+      Node *pred{head_};
+      for (std::uint32_t i = max_level; i-- > 0;) {
+        Node *cur{to_node(pred->next(i).load(std::memory_order_acquire))};
+        while (cur) {
+          link_t_ succ{cur->next(i).load(std::memory_order_acquire)};
+          if (is_marked(succ)) {
+            link_t_ expected{to_link(cur)};
+            if (!pred->next(i).compare_exchange_strong(expected, succ & ~mark_bit, std::memory_order_release,
+                                                       std::memory_order_relaxed)) {
+              goto retry;
+            }
+            cur = to_node(succ);
+            continue;
+          }
+          if (!is_less(cur, key)) {
+            break;
+          }
+          pred = cur;
+          cur = to_node(succ);
+        }
+        preds[i] = pred;
+        succs[i] = cur;
+      }
+      return is_equal(succs[0], key);
+    }
+
+    /**
+     * 只读的查找, 返回第一个键不小于 `key` 且未删除的节点.
+     */
+    auto search(const Key &key) const -> Node * {
+      Node *pred{head_};
+      Node *cur{};
+      for (std::uint32_t i = max_level; i-- > 0;) {
+        cur = to_node(pred->next(i).load(std::memory_order_acquire));
+        while (cur) {
+          link_t_ succ{cur->next(i).load(std::memory_order_acquire)};
+          if (!is_marked(succ)) {
+            if (!is_less(cur, key)) {
+              break;
+            }
+            pred = cur;
+          }
+          cur = to_node(succ);
+        }
+      }
+      return cur;
+    }
+
+    static auto next_live(Node *node) -> Node * {
+      Node *cur{to_node(node->next(0).load(std::memory_order_acquire))};
+      while (cur && is_marked(cur->next(0).load(std::memory_order_acquire))) {
+        cur = to_node(cur->next(0).load(std::memory_order_acquire));
+      }
+      return cur;
+    }
+
+    /**
+     * 插入方与删除方各调用一次, 后到者返回 `true`, 负责摘除并 retire.
+     */
+    static auto finish(Node *node) -> bool {
+      return node->finish_cnt_.fetch_add(1, std::memory_order_acq_rel) == 1;
+    }
+
+    void unlink_and_retire(Node *node) {
+      {
+        auto guard{domain_.guard()};
+        Preds_ preds, succs;
+        find_preds(node->key(), preds, succs);
+      }
+      domain_.retire(node, node);
+    }
+
+  public:
+    class Range;
+
+    /**
+     * @brief `Range` 的前向迭代器, 与 `std::default_sentinel` 比较判断结束.
+     */
+    class Iterator {
+    private:
+      friend class Range;
+
+      Node *cur_{};
+      const Range *range_{};
+
+      Iterator(Node *cur, const Range *range) : cur_{cur}, range_{range} {
+        clamp();
+      }
+
+      void clamp() {
+        if (cur_ && range_->hi_.has_value() && !range_->map_->is_less(cur_, range_->hi_.value())) {
+          cur_ = nullptr;
+        }
+      }
+
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = SkipListMap::value_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const value_type *;
+      using reference = const value_type &;
+
+      Iterator() = default;
+
+      auto operator*() const -> reference {
+        return cur_->kv();
+      }
+
+      auto operator->() const -> pointer {
+        return &cur_->kv();
+      }
+
+      auto operator++() -> Iterator & {
+        cur_ = next_live(cur_);
+        clamp();
+        return *this;
+      }
+
+      auto operator++(int) -> Iterator {
+        Iterator tmp{*this};
+        ++*this;
+        return tmp;
+      }
+
+      auto operator==(const Iterator &that) const -> bool {
+        return cur_ == that.cur_;
+      }
+
+      auto operator==(std::default_sentinel_t) const -> bool {
+        return !cur_;
+      }
+    };
+
+    /**
+     * @brief 键位于 `[lo, hi)` 的元素, 存活期间持有读侧保护.
+     *
+     * 可以嵌套调用本 map 的其他操作. 不应跨越长时间的阻塞持有, 否则其间 retire 的节点都无法回收.
+     */
+    class Range {
+    private:
+      friend class SkipListMap;
+      friend class Iterator;
+
+      Guard_ guard_;
+      const SkipListMap *map_;
+      Node *first_;
+      std::optional<Key> hi_;
+
+      /**
+       * 花括号初始化按从左到右求值, `guard` 先于 `first` 的查找进入读侧保护.
+       */
+      Range(Guard_ &&guard, const SkipListMap *map, Node *first, std::optional<Key> &&hi)
+          : guard_{std::move(guard)}, map_{map}, first_{first}, hi_{std::move(hi)} {
+      }
+
+    public:
+      Range(const Range &) = delete;
+      auto operator=(const Range &) -> Range & = delete;
+      Range(Range &&) = delete;
+      auto operator=(Range &&) -> Range & = delete;
+
+      auto begin() const -> Iterator {
+        return Iterator{first_, this};
+      }
+
+      auto end() const -> std::default_sentinel_t {
+        return std::default_sentinel;
+      }
+    };
+
+    explicit SkipListMap(const Compare &comp = Compare{})
+        : head_{create_node(max_level)}, comp_{comp}, domain_{NodeOps{}} {
+    }
+
+    SkipListMap(const SkipListMap &) = delete;
+    auto operator=(const SkipListMap &) -> SkipListMap & = delete;
+    SkipListMap(SkipListMap &&) = delete;
+    auto operator=(SkipListMap &&) -> SkipListMap & = delete;
+
+    /**
+     * 析构时不应有其他线程访问. 已 retire 的节点由 `domain_` 释放.
+     */
+    ~SkipListMap() {
+      Node *node{to_node(head_->next(0).load(std::memory_order_relaxed))};
+      while (node) {
+        Node *next{to_node(node->next(0).load(std::memory_order_relaxed))};
+        destroy_node(node);
+        node = next;
+      }
+      free_node(head_);
+    }
+
+    /**
+     * 键已存在时不插入.
+     *
+     * @return 是否插入.
+     */
+    template<typename... Args>
+    auto emplace(Key key, Args &&...args) -> bool {
+      std::uint32_t level{random_level()};
+      Node *node{create_node(level)};
+      std::construct_at(&node->kv(), std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+      {
+        auto guard{domain_.guard()};
+        Preds_ preds, succs;
+        while (true) {
+          if (find_preds(node->key(), preds, succs)) {
+            destroy_node(node);
+            return false;
+          }
+          for (std::uint32_t i = 0; i < level; i++) {
+            node->next(i).store(to_link(succs[i]), std::memory_order_relaxed);
+          }
+          link_t_ expected{to_link(succs[0])};
+          if (preds[0]->next(0).compare_exchange_strong(expected, to_link(node), std::memory_order_release,
+                                                        std::memory_order_relaxed)) {
+            break;
+          }
+        }
+        for (std::uint32_t i = 1; i < level;) {
+          link_t_ expected{to_link(succs[i])};
+          if (preds[i]->next(i).compare_exchange_strong(expected, to_link(node), std::memory_order_release,
+                                                        std::memory_order_relaxed)) {
+            i++;
+            continue;
+          }
+          find_preds(node->key(), preds, succs);
+          if (succs[0] != node) {
+            break; // 已被删除并摘除
+          }
+          link_t_ link{node->next(i).load(std::memory_order_acquire)};
+          if (is_marked(link) || !node->next(i).compare_exchange_strong(link, to_link(succs[i]),
+                                                                        std::memory_order_release,
+                                                                        std::memory_order_relaxed)) {
+            break; // 已被标记
+          }
+        }
+      }
+      if (finish(node)) {
+        unlink_and_retire(node);
+      }
+      return true;
+    }
+
+    auto insert(Key key, const ValType &val) -> bool {
+      return emplace(std::move(key), val);
+    }
+
+    auto insert(Key key, ValType &&val) -> bool {
+      return emplace(std::move(key), std::move(val));
+    }
+
+    /**
+     * @return 是否由本次调用删除.
+     */
+    auto erase(const Key &key) -> bool {
+      Node *node{};
+      {
+        auto guard{domain_.guard()};
+        Preds_ preds, succs;
+        if (!find_preds(key, preds, succs)) {
+          return false;
+        }
+        node = succs[0];
+        for (std::uint32_t i = node->level_; i-- > 1;) {
+          node->next(i).fetch_or(mark_bit, std::memory_order_acq_rel);
+        }
+        if (is_marked(node->next(0).fetch_or(mark_bit, std::memory_order_acq_rel))) {
+          return false;
+        }
+        if (!finish(node)) {
+          find_preds(key, preds, succs);
+          return true;
+        }
+      }
+      unlink_and_retire(node);
+      return true;
+    }
+
+    auto find(const Key &key) -> std::optional<ValType> {
+      auto guard{domain_.guard()};
+      if (Node *node{search(key)}; is_equal(node, key)) {
+        return node->kv().second;
+      }
+      return std::nullopt;
+    }
+
+    auto contains(const Key &key) -> bool {
+      auto guard{domain_.guard()};
+      return is_equal(search(key), key);
+    }
+
+    /**
+     * 键不小于 `key` 的所有元素.
+     */
+    auto lower_bound(const Key &key) -> Range {
+      return Range{domain_.guard(), this, search(key), std::nullopt};
+    }
+
+    /**
+     * 键位于 `[lo, hi)` 的所有元素.
+     */
+    auto range(const Key &lo, Key hi) -> Range {
+      return Range{domain_.guard(), this, search(lo), std::make_optional(std::move(hi))};
+    }
+
+    auto all() -> Range {
+      return Range{domain_.guard(), this, next_live(head_), std::nullopt};
+    }
+  };
+
+} // namespace SimpleCU
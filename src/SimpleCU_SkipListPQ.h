@@ -0,0 +1,301 @@
+#pragma once
+#include "SimpleCU_Reclaim.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU {
+
+  /**
+   * @brief 基于无锁跳表的优先队列 (Lindén-Jonsson).
+   *
+   * 删除标记放在前驱 `next[0]` 的最低位: 标记置位表示后继已被删除. `pop` 从头沿第 0 层跳过已标记的前缀,
+   * 在第一个未标记的指针上 `fetch_or` 置位, 取得其后继. 竞争者之间没有 CAS 失败重试, 只各自向后推进.
+   *
+   * 被删除的节点总是构成链表的前缀, 且标记置位后不能再在其后插入. 前缀不逐个摘除, 而是累计超过 `bound_offset`
+   * 个后由一次 CAS `head_->next[0]` 整段摘下, 再修正高层指针, 整段 retire 一次.
+   * 仍在链接高层指针的节点 (`inserting_`) 及其之后的节点不会被摘下.
+   *
+   * 相同的键按插入的逆序取出.
+   *
+   * @tparam Key 优先级, `Compare` 意义下较小者先出队.
+   * @tparam ValType 元素类型.
+   * @tparam Compare 键的严格弱序.
+   * @tparam Reclaimer 节点的回收策略, 需要能保护沿 `next` 的遍历, 默认 `Reclaim::QSBRPolicy`.
+   */
+  template<typename Key, typename ValType, typename Compare = std::less<Key>,
+           typename Reclaimer = Reclaim::QSBRPolicy<>>
+    requires Reclaimer::protects_traversal
+  class SkipListPQ {
+  private:
+    using link_t_ = std::uintptr_t;
+
+    constexpr static std::uint32_t max_level{24};
+    constexpr static link_t_ mark_bit{1};
+
+    /**
+     * 头节点不构造键和元素. `level_` 个 `next` 指针紧随节点之后分配, 只有第 0 层会被标记.
+     */
+    struct alignas(std::atomic<link_t_>) Node {
+      const std::uint32_t level_;
+      std::atomic<bool> inserting_{};
+      alignas(Key) std::byte key_[sizeof(Key)];
+      alignas(ValType) std::byte val_[sizeof(ValType)];
+
+      explicit Node(std::uint32_t level) : level_{level} {
+      }
+
+      auto key() -> const Key & {
+        return *std::launder(reinterpret_cast<Key *>(key_));
+      }
+
+      auto val() -> ValType * {
+        return std::launder(reinterpret_cast<ValType *>(val_));
+      }
+
+      auto next(std::uint32_t i) -> std::atomic<link_t_> & {
+        return std::launder(reinterpret_cast<std::atomic<link_t_> *>(this + 1))[i];
+      }
+    };
+
+    struct NodeOps {
+      static auto next(Node *node) -> Node * {
+        return to_node(node->next(0).load(std::memory_order_relaxed));
+      }
+
+      void destroy(Node *node) {
+        destroy_node(node);
+      }
+    };
+
+    using Domain_ = typename Reclaimer::template Domain<Node, NodeOps>;
+    using Preds_ = std::array<Node *, max_level>;
+
+    Node *head_;
+    const std::size_t bound_offset_;
+    [[no_unique_address]] Compare comp_;
+    Domain_ domain_;
+
+    static auto is_marked(link_t_ link) -> bool {
+      return (link & mark_bit) != 0;
+    }
+
+    static auto to_node(link_t_ link) -> Node * {
+      return reinterpret_cast<Node *>(link & ~mark_bit);
+    }
+
+    static auto to_link(Node *node) -> link_t_ {
+      return reinterpret_cast<link_t_>(node);
+    }
+
+    static auto alloc_size(std::uint32_t level) -> std::size_t {
+      return sizeof(Node) + level * sizeof(std::atomic<link_t_>);
+    }
+
+    static auto random_level() -> std::uint32_t {
+      return std::min<std::uint32_t>(std::countr_one(Utils::fast_random()) + 1, max_level);
+    }
+
+    static auto create_node(std::uint32_t level) -> Node * {
+      void *mem{::operator new(alloc_size(level), std::align_val_t{alignof(Node)})};
+      Node *node{std::construct_at(static_cast<Node *>(mem), level)};
+      for (std::uint32_t i = 0; i < level; i++) {
+        std::construct_at(&node->next(i), link_t_{});
+      }
+      return node;
+    }
+
+    static void free_node(Node *node) {
+      std::uint32_t level{node->level_};
+      std::destroy_at(node);
+      ::operator delete(static_cast<void *>(node), alloc_size(level), std::align_val_t{alignof(Node)});
+    }
+
+    static void destroy_node(Node *node) {
+      std::destroy_at(&node->key());
+      std::destroy_at(node->val());
+      free_node(node);
+    }
+
+    auto is_less(Node *node, const Key &key) -> bool {
+      return comp_(node->key(), key);
+    }
+
+    /**
+     * 找到每层最后一个键小于 `key` 的节点及其后继. 第 0 层还会越过所有已删除的节点,
+     * 新节点只能插在已删除的前缀之后. 返回第 0 层遇到的最后一个已删除节点.
+     */
+    auto locate_preds(const Key &key, Preds_ &preds, Preds_ &succs) -> Node * {
+      Node *x{head_};
+      Node *del{};
+      for (std::uint32_t i = max_level; i-- > 0;) {
+        link_t_ link{x->next(i).load(std::memory_order_acquire)};
+        Node *cur{to_node(link)};
+        while (cur && (is_less(cur, key) || is_marked(cur->next(0).load(std::memory_order_acquire)) ||
+                       (i == 0 && is_marked(link)))) {
+          if (i == 0 && is_marked(link)) {
+            del = cur;
+          }
+          x = cur;
+          link = x->next(i).load(std::memory_order_acquire);
+          cur = to_node(link);
+        }
+        preds[i] = x;
+        succs[i] = cur;
+      }
+      return del;
+    }
+
+    /**
+     * 前缀摘下后, 令 `head_` 的各高层指针越过已删除且后继也已删除的节点.
+     */
+    void restructure() {
+      Node *pred{head_};
+      for (std::uint32_t i = max_level - 1; i > 0;) {
+        link_t_ head_link{head_->next(i).load(std::memory_order_acquire)};
+        Node *h{to_node(head_link)};
+        if (!h || !is_marked(h->next(0).load(std::memory_order_acquire))) {
+          i--;
+          continue;
+        }
+        Node *cur{to_node(pred->next(i).load(std::memory_order_acquire))};
+        while (cur && is_marked(cur->next(0).load(std::memory_order_acquire))) {
+          pred = cur;
+          cur = to_node(pred->next(i).load(std::memory_order_acquire));
+        }
+        if (head_->next(i).compare_exchange_strong(head_link, to_link(cur), std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+          i--;
+        }
+      }
+    }
+
+  public:
+    /**
+     * @param bound_offset 已删除前缀超过此长度时才整段摘下.
+     */
+    explicit SkipListPQ(std::size_t bound_offset = 32, const Compare &comp = Compare{})
+        : head_{create_node(max_level)}, bound_offset_{bound_offset}, comp_{comp}, domain_{NodeOps{}} {
+    }
+
+    SkipListPQ(const SkipListPQ &) = delete;
+    auto operator=(const SkipListPQ &) -> SkipListPQ & = delete;
+    SkipListPQ(SkipListPQ &&) = delete;
+    auto operator=(SkipListPQ &&) -> SkipListPQ & = delete;
+
+    /**
+     * 析构时不应有其他线程访问. 已 retire 的节点由 `domain_` 释放.
+     */
+    ~SkipListPQ() {
+      Node *node{to_node(head_->next(0).load(std::memory_order_relaxed))};
+      while (node) {
+        Node *next{NodeOps::next(node)};
+        destroy_node(node);
+        node = next;
+      }
+      free_node(head_);
+    }
+
+    template<typename... Args>
+    void emplace(Key key, Args &&...args) {
+      std::uint32_t level{random_level()};
+      Node *node{create_node(level)};
+      std::construct_at(reinterpret_cast<Key *>(node->key_), std::move(key));
+      std::construct_at(reinterpret_cast<ValType *>(node->val_), std::forward<Args>(args)...);
+      node->inserting_.store(true, std::memory_order_relaxed);
+
+      auto guard{domain_.guard()};
+      Preds_ preds, succs;
+      Node *del{};
+      while (true) {
+        del = locate_preds(node->key(), preds, succs);
+        node->next(0).store(to_link(succs[0]), std::memory_order_relaxed);
+        link_t_ expected{to_link(succs[0])};
+        if (preds[0]->next(0).compare_exchange_strong(expected, to_link(node), std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+          break;
+        }
+      }
+      for (std::uint32_t i = 1; i < level;) {
+        node->next(i).store(to_link(succs[i]), std::memory_order_relaxed);
+        // 自身或后继已被删除时不再链接高层, 避免高层指针指向可能被摘下的节点
+        if (is_marked(node->next(0).load(std::memory_order_acquire)) ||
+            (succs[i] && (is_marked(succs[i]->next(0).load(std::memory_order_acquire)) || succs[i] == del))) {
+          break;
+        }
+        link_t_ expected{to_link(succs[i])};
+        if (preds[i]->next(i).compare_exchange_strong(expected, to_link(node), std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+          i++;
+          continue;
+        }
+        del = locate_preds(node->key(), preds, succs);
+        if (succs[0] != node) {
+          break;
+        }
+      }
+      node->inserting_.store(false, std::memory_order_release);
+    }
+
+    void push(Key key, const ValType &val) {
+      emplace(std::move(key), val);
+    }
+
+    void push(Key key, ValType &&val) {
+      emplace(std::move(key), std::move(val));
+    }
+
+    /**
+     * 取出键最小的元素 (delete_min), 队列为空时返回 `std::nullopt`.
+     */
+    auto pop() -> std::optional<std::pair<Key, ValType>> {
+      Node *first{}, *last{};
+      std::optional<std::pair<Key, ValType>> ret{};
+      {
+        auto guard{domain_.guard()};
+        link_t_ obs_head{head_->next(0).load(std::memory_order_acquire)};
+        Node *x{head_};
+        Node *new_head{};
+        std::size_t offset{};
+        link_t_ link{};
+        do {
+          link = x->next(0).load(std::memory_order_acquire);
+          if (!to_node(link)) {
+            return std::nullopt;
+          }
+          if (!new_head && x->inserting_.load(std::memory_order_acquire)) {
+            new_head = x;
+          }
+          if (!is_marked(link)) {
+            link = x->next(0).fetch_or(mark_bit, std::memory_order_acq_rel);
+          }
+          offset++;
+          x = to_node(link);
+        } while (is_marked(link));
+        ret.emplace(x->key(), std::move(*x->val()));
+
+        if (!new_head) {
+          new_head = x;
+        }
+        if (offset <= bound_offset_ || head_->next(0).load(std::memory_order_relaxed) != obs_head) {
+          return ret;
+        }
+        if (!head_->next(0).compare_exchange_strong(obs_head, to_link(new_head) | mark_bit,
+                                                    std::memory_order_acq_rel, std::memory_order_relaxed)) {
+          return ret;
+        }
+        restructure();
+        first = to_node(obs_head);
+        if (first == new_head) {
+          return ret;
+        }
+        last = first;
+        while (NodeOps::next(last) != new_head) {
+          last = NodeOps::next(last);
+        }
+      }
+      domain_.retire(first, last);
+      return ret;
+    }
+  };
+
+} // namespace SimpleCU
@@ -0,0 +1,301 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU::SplitRC::Details {
+
+  /**
+   * 控制块, 只持有内部计数.
+   * 外部计数以 16 位 tag 的形式打包在 `AtomicSharedPtr` 的指针高位中, 由 swap 出控制块的线程合并进内部计数.
+   */
+  template<typename ValType>
+  class ControlBlock {
+  private:
+    std::atomic<std::int64_t> ref_cnt_{1};
+
+  protected:
+    ValType *ptr_{};
+
+  public:
+    ControlBlock() = default;
+    ControlBlock(ValType *ptr) : ptr_{ptr} {
+    }
+    ControlBlock(const ControlBlock &) = delete;
+    auto operator=(const ControlBlock &) -> ControlBlock & = delete;
+    virtual ~ControlBlock() = default;
+
+    auto get() const -> ValType * {
+      return ptr_;
+    }
+
+    auto get_cnt() const -> std::int64_t {
+      return ref_cnt_.load(std::memory_order_relaxed);
+    }
+
+    void add_ref(std::int64_t cnt) {
+      ref_cnt_.fetch_add(cnt, std::memory_order_relaxed);
+    }
+
+    void release_ref(std::int64_t cnt) {
+      if (ref_cnt_.fetch_sub(cnt, std::memory_order_acq_rel) == cnt) {
+        delete this;
+      }
+    }
+  };
+
+  template<typename ValType, typename DeleterType>
+  class PtrControlBlock : public ControlBlock<ValType>, private Utils::EBODeleterStorage<DeleterType> {
+  private:
+    using DeleterStorage_ = Utils::EBODeleterStorage<DeleterType>;
+
+  public:
+    template<typename DeleterType_ = DeleterType>
+    PtrControlBlock(ValType *ptr, DeleterType_ &&deleter)
+        : ControlBlock<ValType>{ptr}, DeleterStorage_{std::forward<DeleterType_>(deleter)} {
+    }
+    ~PtrControlBlock() override {
+      this->get_deleter()(this->ptr_);
+    }
+  };
+
+  /** `make_shared` 使用, 元素与控制块一次分配. */
+  template<typename ValType>
+  class InplaceControlBlock : public ControlBlock<ValType> {
+  private:
+    ValType val_;
+
+  public:
+    template<typename... Args>
+    InplaceControlBlock(Args &&...args) : val_(std::forward<Args>(args)...) {
+      this->ptr_ = &val_;
+    }
+  };
+
+} // namespace SimpleCU::SplitRC::Details
+
+namespace SimpleCU::SplitRC {
+
+  template<typename ValType>
+  class AtomicSharedPtr;
+
+  /**
+   * @brief 引用计数指针, 可被 `AtomicSharedPtr` 原子地发布.
+   *
+   * @tparam ValType 元素类型.
+   */
+  template<typename ValType>
+  class SharedPtr {
+  private:
+    using ControlBlock_ = Details::ControlBlock<ValType>;
+
+    ControlBlock_ *ctrl_{};
+
+    friend class AtomicSharedPtr<ValType>;
+
+    template<typename ValType_, typename... Args>
+    friend auto make_shared(Args &&...args) -> SharedPtr<ValType_>;
+
+    /** 接管一个已经计入 `ctrl` 的引用. */
+    explicit SharedPtr(ControlBlock_ *ctrl) : ctrl_{ctrl} {
+    }
+
+    auto release() -> ControlBlock_ * {
+      return std::exchange(ctrl_, nullptr);
+    }
+
+  public:
+    SharedPtr() = default;
+    SharedPtr(std::nullptr_t) {
+    }
+
+    template<typename DeleterType = Utils::DefaultDeleter<ValType>>
+    explicit SharedPtr(ValType *ptr, DeleterType &&deleter = DeleterType{})
+        : ctrl_{ptr ? new Details::PtrControlBlock<ValType, std::decay_t<DeleterType>>{
+                          ptr, std::forward<DeleterType>(deleter)}
+                    : nullptr} {
+    }
+
+    SharedPtr(const SharedPtr &that) : ctrl_{that.ctrl_} {
+      if (ctrl_) {
+        ctrl_->add_ref(1);
+      }
+    }
+    SharedPtr(SharedPtr &&that) noexcept : ctrl_{that.release()} {
+    }
+
+    auto operator=(const SharedPtr &that) -> SharedPtr & {
+      SharedPtr{that}.swap(*this);
+      return *this;
+    }
+    auto operator=(SharedPtr &&that) noexcept -> SharedPtr & {
+      SharedPtr{std::move(that)}.swap(*this);
+      return *this;
+    }
+
+    ~SharedPtr() {
+      if (ctrl_) {
+        ctrl_->release_ref(1);
+      }
+    }
+
+    void swap(SharedPtr &that) noexcept {
+      std::swap(ctrl_, that.ctrl_);
+    }
+
+    void reset() {
+      SharedPtr{}.swap(*this);
+    }
+
+    auto get() const -> ValType * {
+      return ctrl_ ? ctrl_->get() : nullptr;
+    }
+
+    auto operator*() const -> ValType & {
+      return *get();
+    }
+
+    auto operator->() const -> ValType * {
+      return get();
+    }
+
+    explicit operator bool() const {
+      return ctrl_ != nullptr;
+    }
+
+    /** 不含尚未合并的外部计数, 仅供参考. */
+    auto use_count() const -> std::int64_t {
+      return ctrl_ ? ctrl_->get_cnt() : 0;
+    }
+
+    friend auto operator==(const SharedPtr &lhs, const SharedPtr &rhs) -> bool {
+      return lhs.ctrl_ == rhs.ctrl_;
+    }
+  };
+
+  template<typename ValType, typename... Args>
+  auto make_shared(Args &&...args) -> SharedPtr<ValType> {
+    return SharedPtr<ValType>{new Details::InplaceControlBlock<ValType>{std::forward<Args>(args)...}};
+  }
+
+  /**
+   * @brief Split Reference Counting 的原子 `SharedPtr`.
+   *
+   * 第三种回收方案, 不要求读者临界区有界, 也不限制线程数.
+   * 控制块指针占低 48 位, 高 16 位为外部计数 (tag):
+   * `load` 先 `fetch_add` tag 借用当前控制块, 再把借用转换为内部计数, 最后归还 tag;
+   * 若期间控制块已被 swap 出去, 借用已被 swap 方合并进内部计数, 改为归还内部计数.
+   * 全程无锁, `load` 在无竞争时为两次 RMW 加一次 CAS.
+   *
+   * @tparam ValType 元素类型.
+   */
+  template<typename ValType>
+  class AtomicSharedPtr {
+  private:
+    static_assert(sizeof(void *) == 8, "Requires 64-bit pointers.");
+
+    using ControlBlock_ = Details::ControlBlock<ValType>;
+    using packed_t_ = std::uint64_t;
+
+    constexpr static std::uint32_t tag_shift{48};
+    constexpr static packed_t_ tag_one{1ull << tag_shift};
+    constexpr static packed_t_ ptr_mask{tag_one - 1};
+
+    mutable std::atomic<packed_t_> packed_{};
+
+    static auto pack(ControlBlock_ *ctrl) -> packed_t_ {
+      packed_t_ bits{reinterpret_cast<packed_t_>(ctrl)};
+      assert((bits & ~ptr_mask) == 0 && "Pointer exceeds 48 bits.");
+      return bits;
+    }
+
+    static auto unpack_ptr(packed_t_ packed) -> ControlBlock_ * {
+      return reinterpret_cast<ControlBlock_ *>(packed & ptr_mask);
+    }
+
+    static auto unpack_tag(packed_t_ packed) -> std::int64_t {
+      return static_cast<std::int64_t>(packed >> tag_shift);
+    }
+
+    /**
+     * 同一控制块可能被 swap 出去后又重新装入, 此时归还到新一轮的 tag 上也是正确的:
+     * 各轮借用在 "内部计数 + 当前 tag" 的总和里是可互换的, 只需保证 tag 不为负.
+     */
+    void return_borrow(ControlBlock_ *ctrl) const {
+      packed_t_ cur{packed_.load(std::memory_order_relaxed)};
+      while (unpack_ptr(cur) == ctrl && unpack_tag(cur) > 0) {
+        if (packed_.compare_exchange_weak(cur, cur - tag_one, std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+          return;
+        }
+      }
+      if (ctrl) {
+        ctrl->release_ref(1);
+      }
+    }
+
+    /** 把被 swap 出的控制块上挂着的外部计数合并进内部计数, 返回 `AtomicSharedPtr` 原本持有的引用. */
+    static auto take_swapped(packed_t_ old) -> SharedPtr<ValType> {
+      ControlBlock_ *ctrl{unpack_ptr(old)};
+      if (ctrl && unpack_tag(old) > 0) {
+        ctrl->add_ref(unpack_tag(old));
+      }
+      return SharedPtr<ValType>{ctrl};
+    }
+
+  public:
+    AtomicSharedPtr() = default;
+    AtomicSharedPtr(SharedPtr<ValType> desired) : packed_{pack(desired.release())} {
+    }
+    AtomicSharedPtr(const AtomicSharedPtr &) = delete;
+    auto operator=(const AtomicSharedPtr &) -> AtomicSharedPtr & = delete;
+    ~AtomicSharedPtr() {
+      take_swapped(packed_.load(std::memory_order_acquire));
+    }
+
+    constexpr static auto is_lock_free() -> bool {
+      return std::atomic<packed_t_>::is_always_lock_free;
+    }
+
+    auto load() const -> SharedPtr<ValType> {
+      if (!unpack_ptr(packed_.load(std::memory_order_relaxed))) {
+        return SharedPtr<ValType>{};
+      }
+      ControlBlock_ *ctrl{unpack_ptr(packed_.fetch_add(tag_one, std::memory_order_acquire))};
+      if (ctrl) {
+        ctrl->add_ref(1);
+      }
+      return_borrow(ctrl);
+      return SharedPtr<ValType>{ctrl};
+    }
+
+    auto exchange(SharedPtr<ValType> desired) -> SharedPtr<ValType> {
+      return take_swapped(packed_.exchange(pack(desired.release()), std::memory_order_acq_rel));
+    }
+
+    void store(SharedPtr<ValType> desired) {
+      exchange(std::move(desired));
+    }
+
+    /**
+     * 只比较控制块指针, 忽略 tag. 失败时 `expected` 更新为当前值.
+     */
+    auto compare_exchange_strong(SharedPtr<ValType> &expected, SharedPtr<ValType> desired) -> bool {
+      packed_t_ cur{packed_.load(std::memory_order_relaxed)};
+      while (unpack_ptr(cur) == expected.ctrl_) {
+        if (packed_.compare_exchange_weak(cur, pack(desired.ctrl_), std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+          desired.release();
+          take_swapped(cur);
+          return true;
+        }
+      }
+      expected = load();
+      return false;
+    }
+
+    operator SharedPtr<ValType>() const {
+      return load();
+    }
+  };
+
+} // namespace SimpleCU::SplitRC
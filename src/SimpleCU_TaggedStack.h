@@ -0,0 +1,208 @@
+#pragma once
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU::Details {
+
+  /**
+   * @brief 带版本号的原子链表头.
+   *
+   * 支持 16 字节 CAS (x86-64 需 `-mcx16`) 时为完整指针 + 64 位版本号;
+   * 否则把版本号截断为 16 位, 打包在 48 位指针的高位中, 单个线程在两次读取之间被其他线程
+   * 恰好推进 65536 个版本时仍可能 ABA.
+   */
+  template<typename Node>
+  class TaggedHead {
+  public:
+    struct Tagged {
+      Node *ptr_;
+      std::uint64_t tag_;
+    };
+
+  private:
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+    using packed_t_ = unsigned __int128;
+
+    /** 小端: 低 8 字节为指针, 高 8 字节为版本号. */
+    alignas(16) packed_t_ packed_{};
+
+    static auto pack(Tagged val) -> packed_t_ {
+      return (static_cast<packed_t_>(val.tag_) << 64) | reinterpret_cast<std::uintptr_t>(val.ptr_);
+    }
+
+    static auto unpack(packed_t_ packed) -> Tagged {
+      return Tagged{reinterpret_cast<Node *>(static_cast<std::uintptr_t>(packed)),
+                    static_cast<std::uint64_t>(packed >> 64)};
+    }
+
+  public:
+    /**
+     * 两半分别读取, 可能撕裂. 先读版本号再读指针, 撕裂得到的组合版本号必然落后于当前值, 随后的 CAS 一定失败;
+     * 撕裂读到的指针仍指向 type-stable 的节点, 可以安全解引用.
+     */
+    auto load() const -> Tagged {
+      auto *words{reinterpret_cast<const std::uint64_t *>(&packed_)};
+      std::uint64_t tag{__atomic_load_n(&words[1], __ATOMIC_ACQUIRE)};
+      std::uint64_t ptr{__atomic_load_n(&words[0], __ATOMIC_ACQUIRE)};
+      return Tagged{reinterpret_cast<Node *>(ptr), tag};
+    }
+
+    /** 全屏障. 失败时 `expected` 更新为当前值. */
+    auto compare_exchange(Tagged &expected, Tagged desired) -> bool {
+      packed_t_ old{pack(expected)};
+      packed_t_ cur{__sync_val_compare_and_swap(&packed_, old, pack(desired))};
+      if (cur == old) {
+        return true;
+      }
+      expected = unpack(cur);
+      return false;
+    }
+#else
+    using packed_t_ = std::uint64_t;
+    constexpr static std::uint32_t tag_shift{48};
+    constexpr static packed_t_ ptr_mask{(1ull << tag_shift) - 1};
+
+    std::atomic<packed_t_> packed_{};
+
+    static auto pack(Tagged val) -> packed_t_ {
+      auto bits{reinterpret_cast<packed_t_>(val.ptr_)};
+      assert((bits & ~ptr_mask) == 0 && "Pointer exceeds 48 bits.");
+      return bits | (val.tag_ << tag_shift);
+    }
+
+    static auto unpack(packed_t_ packed) -> Tagged {
+      return Tagged{reinterpret_cast<Node *>(packed & ptr_mask), packed >> tag_shift};
+    }
+
+  public:
+    auto load() const -> Tagged {
+      return unpack(packed_.load(std::memory_order_acquire));
+    }
+
+    auto compare_exchange(Tagged &expected, Tagged desired) -> bool {
+      packed_t_ old{pack(expected)};
+      if (packed_.compare_exchange_weak(old, pack(desired), std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return true;
+      }
+      expected = unpack(old);
+      return false;
+    }
+#endif
+  };
+
+} // namespace SimpleCU::Details
+
+namespace SimpleCU {
+
+  /**
+   * @brief 定容量的 Treiber 栈, 以版本号防 ABA.
+   *
+   * 所有节点在构造时一次性分配, 空闲节点位于另一条同样带版本号的空闲链表上, 析构前不会归还.
+   * 节点内存 type-stable, pop 读到已被取走的节点也只会读到无意义的 `next_`, CAS 因版本号变化而失败,
+   * 因此不需要 QSBR 或 Hazard Pointer.
+   *
+   * @tparam ValType 元素类型.
+   * @tparam Backoff CAS 失败后的退避策略.
+   */
+  template<typename ValType, typename Backoff = Utils::NoBackoff>
+  class TaggedStack {
+  private:
+    struct Node {
+      alignas(ValType) std::byte storage_[sizeof(ValType)];
+      std::atomic<Node *> next_;
+
+      auto val() -> ValType * {
+        return std::launder(reinterpret_cast<ValType *>(storage_));
+      }
+    };
+
+    using Head_ = Utils::Aligned<Details::TaggedHead<Node>>;
+    using Tagged_ = typename Details::TaggedHead<Node>::Tagged;
+
+    const std::size_t capacity_;
+    std::unique_ptr<Node[]> nodes_;
+    Head_ head_{};
+    Head_ free_{};
+
+    static void push_node(Head_ &list, Node *node) {
+      Tagged_ old{list.load()};
+      Backoff backoff{};
+      while (true) {
+        node->next_.store(old.ptr_, std::memory_order_relaxed);
+        if (list.compare_exchange(old, Tagged_{node, old.tag_ + 1})) {
+          break;
+        }
+        backoff();
+      }
+    }
+
+    static auto pop_node(Head_ &list) -> Node * {
+      Tagged_ old{list.load()};
+      Backoff backoff{};
+      while (old.ptr_) {
+        Node *next{old.ptr_->next_.load(std::memory_order_relaxed)};
+        if (list.compare_exchange(old, Tagged_{next, old.tag_ + 1})) {
+          return old.ptr_;
+        }
+        backoff();
+      }
+      return nullptr;
+    }
+
+  public:
+    explicit TaggedStack(std::size_t capacity) : capacity_{capacity}, nodes_{std::make_unique<Node[]>(capacity)} {
+      for (std::size_t i = capacity_; i > 0; i--) {
+        push_node(free_, &nodes_[i - 1]);
+      }
+    }
+
+    TaggedStack(const TaggedStack &) = delete;
+    auto operator=(const TaggedStack &) -> TaggedStack & = delete;
+    TaggedStack(TaggedStack &&) = delete;
+    auto operator=(TaggedStack &&) -> TaggedStack & = delete;
+
+    ~TaggedStack() {
+      for (Node *cur = head_.load().ptr_; cur; cur = cur->next_.load(std::memory_order_relaxed)) {
+        std::destroy_at(cur->val());
+      }
+    }
+
+    auto capacity() const -> std::size_t {
+      return capacity_;
+    }
+
+    /**
+     * @return 栈满时返回 `false`, 参数不被消耗.
+     */
+    template<typename... Args>
+    auto emplace(Args &&...args) -> bool {
+      Node *node{pop_node(free_)};
+      if (!node) {
+        return false;
+      }
+      std::construct_at(node->val(), std::forward<Args>(args)...);
+      push_node(head_, node);
+      return true;
+    }
+
+    auto push(const ValType &val) -> bool {
+      return emplace(val);
+    }
+
+    auto push(ValType &&val) -> bool {
+      return emplace(std::move(val));
+    }
+
+    auto pop() -> std::optional<ValType> {
+      Node *node{pop_node(head_)};
+      if (!node) {
+        return std::nullopt;
+      }
+      std::optional<ValType> ret{std::move(*node->val())};
+      std::destroy_at(node->val());
+      push_node(free_, node);
+      return ret;
+    }
+  };
+
+} // namespace SimpleCU
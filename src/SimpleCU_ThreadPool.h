@@ -0,0 +1,333 @@
+#pragma once
+#include "SimpleCU_ChaseLevDeque.h"
+#include "SimpleCU_EventCount.h"
+#include "SimpleCU_MPSCQueue.h"
+#include "SimpleCU_NodePool.h"
+#include "SimpleCU_Utils.h"
+#include <bits/stdc++.h>
+
+namespace SimpleCU::Details {
+
+  /**
+   * 类型擦除的任务, 同时作为 `MPSCQueue` 的节点. `run_` 执行后释放任务本身.
+   */
+  struct PoolTask : MPSCHook {
+    void (*run_)(PoolTask *);
+  };
+
+  template<typename Fn>
+  struct PoolTaskImpl : PoolTask {
+    using Alloc_ = Utils::PoolAllocator<PoolTaskImpl>;
+
+    Fn fn_;
+
+    explicit PoolTaskImpl(Fn &&fn) : PoolTask{{}, &PoolTaskImpl::run}, fn_{std::move(fn)} {
+    }
+
+    static auto create(Fn &&fn) -> PoolTask * {
+      Alloc_ alloc{};
+      PoolTaskImpl *task{std::allocator_traits<Alloc_>::allocate(alloc, 1)};
+      std::construct_at(task, std::move(fn));
+      return task;
+    }
+
+    static void run(PoolTask *base) noexcept {
+      PoolTaskImpl *task{static_cast<PoolTaskImpl *>(base)};
+      task->fn_();
+      std::destroy_at(task);
+      Alloc_ alloc{};
+      std::allocator_traits<Alloc_>::deallocate(alloc, task, 1);
+    }
+  };
+
+} // namespace SimpleCU::Details
+
+namespace SimpleCU {
+
+  class TaskGroup;
+
+  /**
+   * @brief 工作窃取线程池.
+   *
+   * 每个工作线程有一个 `ChaseLevDeque`, 另有一个所有工作线程共享的 `MPSCQueue` 注入队列:
+   * - 工作线程内提交的任务放入自己的 deque, 空闲的工作线程从其他 deque 的另一端窃取;
+   * - 外部线程提交的任务放入注入队列. 每个工作线程每轮都尝试取得消费权, 取得的一方把注入队列转入自己的 deque,
+   *   之后同样可被窃取. 任务不会停留在某个忙碌的工作线程专属的位置上.
+   *
+   * 找不到任务的工作线程先退避 `spin_cnt` 轮 (自旋到上限后让出时间片), 仍没有才在自己的 `EventCount` 上睡眠.
+   * 放入 deque 后只在确实有线程睡眠时才唤醒其中一个.
+   *
+   * 任务不应抛出异常. 析构时等待所有已提交的任务完成.
+   */
+  class ThreadPool {
+  private:
+    friend class TaskGroup;
+
+    constexpr static std::size_t max_thread_cnt{64};
+    constexpr static std::size_t spin_cnt{128};
+
+    using Task_ = Details::PoolTask;
+
+    struct Worker {
+      ChaseLevDeque<Task_ *, Reclaim::QSBRPolicy<max_thread_cnt>> deque_{};
+      Utils::EventCount ec_{};
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::jthread> threads_;
+    Utils::Aligned<std::atomic<std::size_t>> idle_cnt_{};
+    MPSCQueue<Task_> injector_{};
+    /** 注入队列的消费权, 同一时刻只有一个工作线程 drain. acquire / release 使先后的消费者看到彼此对 `tail_` 的修改. */
+    Utils::Aligned<std::atomic<bool>> injector_busy_{};
+    std::atomic<bool> stop_{};
+    Utils::EventCount group_ec_{};
+
+    thread_local inline static ThreadPool *tls_pool_{};
+    thread_local inline static std::size_t tls_idx_{};
+
+    static void run(Task_ *task) {
+      task->run_(task);
+    }
+
+    auto current_worker() const -> std::optional<std::size_t> {
+      return tls_pool_ == this ? std::make_optional(tls_idx_) : std::nullopt;
+    }
+
+    /**
+     * 有线程空闲时唤醒其中一个, 没有时只有一次 fence 和一次 load.
+     */
+    void wake_idle(std::size_t from) {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (idle_cnt_.load(std::memory_order_relaxed) == 0) {
+        return;
+      }
+      for (std::size_t i = 1; i <= workers_.size(); i++) {
+        if (workers_[(from + i) % workers_.size()]->ec_.notify_one()) {
+          return;
+        }
+      }
+    }
+
+    /**
+     * 取得消费权时把注入队列转入 `self` 的 deque. 消费权被占用时跳过, 占用方会在之后的轮次中再次检查.
+     */
+    void drain_injector(std::size_t idx) {
+      if (injector_busy_.load(std::memory_order_relaxed) || injector_busy_.exchange(true, std::memory_order_acquire)) {
+        return;
+      }
+      auto chain{injector_.drain()};
+      injector_busy_.store(false, std::memory_order_release);
+      for (Task_ *task = chain.first_; task;) {
+        Task_ *next{MPSCQueue<Task_>::next(task)};
+        workers_[idx]->deque_.push(task);
+        task = next;
+      }
+      if (chain.cnt_ > 1) {
+        wake_idle(idx);
+      }
+    }
+
+    /**
+     * 依次尝试: 注入队列转入本地 deque, 本地 deque, 从其他 deque 窃取.
+     */
+    auto find_task(std::size_t idx) -> Task_ * {
+      Worker &self{*workers_[idx]};
+      drain_injector(idx);
+      if (std::optional<Task_ *> task{self.deque_.take()}; task.has_value()) {
+        return task.value();
+      }
+      for (std::size_t i = 1; i < workers_.size(); i++) {
+        if (std::optional<Task_ *> task{workers_[(idx + i) % workers_.size()]->deque_.steal()}; task.has_value()) {
+          return task.value();
+        }
+      }
+      return nullptr;
+    }
+
+    void worker_loop(std::size_t idx) {
+      tls_pool_ = this;
+      tls_idx_ = idx;
+      Worker &self{*workers_[idx]};
+      std::size_t spins{};
+      Utils::ExpBackoff<1, 64, true> backoff{};
+      while (true) {
+        if (Task_ *task{find_task(idx)}; task) {
+          run(task);
+          spins = 0;
+          backoff.reset();
+          continue;
+        }
+        if (spins++ < spin_cnt) {
+          backoff();
+          continue;
+        }
+        spins = 0;
+        backoff.reset();
+        idle_cnt_.fetch_add(1, std::memory_order_seq_cst);
+        auto key{self.ec_.prepare_wait()};
+        if (Task_ *task{find_task(idx)}; task) {
+          self.ec_.cancel_wait();
+          idle_cnt_.fetch_sub(1, std::memory_order_relaxed);
+          run(task);
+          continue;
+        }
+        if (stop_.load(std::memory_order_acquire)) {
+          self.ec_.cancel_wait();
+          idle_cnt_.fetch_sub(1, std::memory_order_relaxed);
+          return;
+        }
+        self.ec_.wait(key);
+        idle_cnt_.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+
+    void submit_task(Task_ *task) {
+      if (std::optional<std::size_t> idx{current_worker()}; idx.has_value()) {
+        workers_[idx.value()]->deque_.push(task);
+        wake_idle(idx.value());
+        return;
+      }
+      injector_.push(task);
+      wake_idle(0);
+    }
+
+  public:
+    /**
+     * @param thread_cnt 工作线程数, 至多 64 个.
+     */
+    explicit ThreadPool(std::size_t thread_cnt = std::thread::hardware_concurrency()) {
+      thread_cnt = std::clamp<std::size_t>(thread_cnt, 1, max_thread_cnt);
+      for (std::size_t i = 0; i < thread_cnt; i++) {
+        workers_.emplace_back(std::make_unique<Worker>());
+      }
+      for (std::size_t i = 0; i < thread_cnt; i++) {
+        threads_.emplace_back([this, i]() { worker_loop(i); });
+      }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+    ThreadPool(ThreadPool &&) = delete;
+    auto operator=(ThreadPool &&) -> ThreadPool & = delete;
+
+    ~ThreadPool() {
+      stop_.store(true, std::memory_order_release);
+      for (auto &worker : workers_) {
+        worker->ec_.notify_all();
+      }
+      threads_.clear();
+    }
+
+    auto thread_cnt() const -> std::size_t {
+      return workers_.size();
+    }
+
+    template<typename Fn>
+    void submit(Fn &&fn) {
+      submit_task(Details::PoolTaskImpl<std::decay_t<Fn>>::create(std::forward<Fn>(fn)));
+    }
+
+    /**
+     * 对 `[first, last)` 中的每个下标调用 `fn`, 返回时全部完成.
+     * 区间对半拆分, 右半作为任务提交, 被窃取的总是剩余中最大的一块. 调用方线程也参与执行.
+     *
+     * @param grain 不再拆分的区间长度, 为 0 时按线程数自动选择.
+     */
+    template<std::integral Index, typename Fn>
+    void parallel_for(Index first, Index last, Fn &&fn, std::size_t grain = 0);
+  };
+
+  /**
+   * @brief 一组任务, `wait` 返回时组内任务 (包括任务中再加入本组的任务) 都已完成.
+   *
+   * 工作线程内 `wait` 时继续执行线程池中的任务, 不会因嵌套等待而死锁; 外部线程则在线程池的 `EventCount` 上睡眠.
+   */
+  class TaskGroup {
+  private:
+    /** 外部线程睡眠前置位, 只有带此位的组在计数归零时才唤醒. */
+    constexpr static std::size_t waiting_bit{std::size_t{1} << (std::numeric_limits<std::size_t>::digits - 1)};
+
+    ThreadPool *pool_;
+    Utils::Aligned<std::atomic<std::size_t>> pending_{};
+
+    auto pending_cnt() -> std::size_t {
+      return pending_.load(std::memory_order_acquire) & ~waiting_bit;
+    }
+
+  public:
+    explicit TaskGroup(ThreadPool &pool) : pool_{&pool} {
+    }
+
+    TaskGroup(const TaskGroup &) = delete;
+    auto operator=(const TaskGroup &) -> TaskGroup & = delete;
+    TaskGroup(TaskGroup &&) = delete;
+    auto operator=(TaskGroup &&) -> TaskGroup & = delete;
+
+    ~TaskGroup() {
+      wait();
+    }
+
+    /**
+     * 任务完成后只访问线程池, 不再访问本组, `wait` 返回后本组可以立即析构.
+     */
+    template<typename Fn>
+    void run(Fn &&fn) {
+      pending_.fetch_add(1, std::memory_order_relaxed);
+      pool_->submit([this, pool = pool_, fn = std::forward<Fn>(fn)]() mutable {
+        fn();
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == (waiting_bit | 1)) {
+          pool->group_ec_.notify_all();
+        }
+      });
+    }
+
+    void wait() {
+      if (std::optional<std::size_t> idx{pool_->current_worker()}; idx.has_value()) {
+        Utils::ExpBackoff<1, 64, true> backoff{};
+        while (pending_cnt() != 0) {
+          if (Details::PoolTask *task{pool_->find_task(idx.value())}; task) {
+            ThreadPool::run(task);
+            backoff.reset();
+            continue;
+          }
+          backoff();
+        }
+        return;
+      }
+      while (pending_cnt() != 0) {
+        auto key{pool_->group_ec_.prepare_wait()};
+        if ((pending_.fetch_or(waiting_bit, std::memory_order_seq_cst) & ~waiting_bit) == 0) {
+          pool_->group_ec_.cancel_wait();
+          break;
+        }
+        pool_->group_ec_.wait(key);
+      }
+      pending_.store(0, std::memory_order_relaxed);
+    }
+  };
+
+  template<std::integral Index, typename Fn>
+  void ThreadPool::parallel_for(Index first, Index last, Fn &&fn, std::size_t grain) {
+    if (first >= last) {
+      return;
+    }
+    std::size_t len{static_cast<std::size_t>(last - first)};
+    if (grain == 0) {
+      grain = std::max<std::size_t>(1, len / (thread_cnt() * 8));
+    }
+    TaskGroup group{*this};
+    auto split{[&group, &fn, grain](auto &self, Index lo, Index hi) -> void {
+      while (static_cast<std::size_t>(hi - lo) > grain) {
+        Index mid{static_cast<Index>(lo + (hi - lo) / 2)};
+        group.run([&self, mid, hi]() { self(self, mid, hi); });
+        hi = mid;
+      }
+      for (; lo < hi; ++lo) {
+        fn(lo);
+      }
+    }};
+    split(split, first, last);
+    group.wait();
+  }
+
+} // namespace SimpleCU
@@ -3,19 +3,62 @@
 
 namespace SimpleCU::Utils {
 
-  constexpr static std::size_t ALIGNMENT{std::hardware_constructive_interference_size};
+  /**
+   * @brief 填充策略.
+   *
+   * 填充 Epoch / Hazard Pointer 槽位是为了避免 false sharing, 应按 destructive interference size 对齐.
+   * 现代 Intel 的相邻行预取器成对读取 cacheline, 此时需要 `Line128` 才能完全隔开.
+   * 可通过 `-DSIMPLECU_PADDING_PROFILE=Line128` 等修改默认策略.
+   */
+  enum class PaddingProfile {
+    None,
+    Line64,
+    Line128,
+    Destructive,
+  };
+
+#ifndef SIMPLECU_PADDING_PROFILE
+#define SIMPLECU_PADDING_PROFILE Destructive
+#endif
+
+  constexpr static PaddingProfile DEFAULT_PADDING{PaddingProfile::SIMPLECU_PADDING_PROFILE};
 
-  template<typename ValType, typename Requires = void>
+  /** GCC 对直接使用 `std::hardware_destructive_interference_size` 给出 ABI 警告, 优先取其底层宏. */
+#ifdef __GCC_DESTRUCTIVE_SIZE
+  constexpr static std::size_t DESTRUCTIVE_SIZE{__GCC_DESTRUCTIVE_SIZE};
+#else
+  constexpr static std::size_t DESTRUCTIVE_SIZE{std::hardware_destructive_interference_size};
+#endif
+
+  constexpr auto padding_of(PaddingProfile profile) -> std::size_t {
+    switch (profile) {
+      case PaddingProfile::None:
+        return 0;
+      case PaddingProfile::Line64:
+        return 64;
+      case PaddingProfile::Line128:
+        return 128;
+      case PaddingProfile::Destructive:
+        return DESTRUCTIVE_SIZE;
+    }
+    return 0;
+  }
+
+  constexpr static std::size_t ALIGNMENT{padding_of(DEFAULT_PADDING)};
+
+  template<typename ValType, PaddingProfile Profile = DEFAULT_PADDING, typename Requires = void>
   struct Aligned {};
 
-  template<typename ValType>
-  struct alignas(ALIGNMENT) Aligned<ValType, std::enable_if_t<std::is_class_v<ValType>>> : public ValType {
+  template<typename ValType, PaddingProfile Profile>
+  struct alignas(std::max(padding_of(Profile), alignof(ValType)))
+      Aligned<ValType, Profile, std::enable_if_t<std::is_class_v<ValType>>> : public ValType {
     using ValType::ValType;
     using ValType::operator=;
   };
 
-  template<typename ValType>
-  struct alignas(ALIGNMENT) Aligned<ValType, std::enable_if_t<!std::is_class_v<ValType>>> {
+  template<typename ValType, PaddingProfile Profile>
+  struct alignas(std::max(padding_of(Profile), alignof(ValType)))
+      Aligned<ValType, Profile, std::enable_if_t<!std::is_class_v<ValType>>> {
     ValType val_;
 
     Aligned() = default;
@@ -35,9 +78,116 @@ namespace SimpleCU::Utils {
     }
   };
 
+  /**
+   * 布局检查: 对象独占 `Profile` 要求的整数个填充单元, 数组中相邻元素不会落在同一单元.
+   */
+  template<typename ValType, PaddingProfile Profile = DEFAULT_PADDING>
+  constexpr static bool is_padded_v{padding_of(Profile) == 0 || (alignof(ValType) >= padding_of(Profile) &&
+                                                                 sizeof(ValType) % padding_of(Profile) == 0)};
+
+  /**
+   * 自旋等待提示, 降低自旋时的功耗并让出超线程的执行资源.
+   */
+  inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+  }
+
+  /**
+   * 每线程独立状态的 xorshift, 用于退避抖动和随机选择槽位.
+   */
+  inline auto fast_random() -> std::uint32_t {
+    thread_local std::uint32_t state{
+        static_cast<std::uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u};
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  /**
+   * 不退避, CAS 失败后立即重试.
+   */
+  struct NoBackoff {
+    void operator()() {
+    }
+    void reset() {
+    }
+  };
+
+  /**
+   * @brief 有界指数退避.
+   *
+   * 每次调用 spin `[cur_ / 2, cur_)` 次 `cpu_relax` (随机抖动避免多个线程同步重试), 之后 `cur_` 翻倍直到 `MaxSpin`.
+   * `YieldOnMax` 时, 达到上限后改为 `std::this_thread::yield`, 适合线程数超过核数的场景.
+   *
+   * 每次 CAS 重试循环在栈上构造一个新对象.
+   */
+  template<std::uint32_t MinSpin = 4, std::uint32_t MaxSpin = 1024, bool YieldOnMax = false>
+  class ExpBackoff {
+  private:
+    static_assert(MinSpin > 0 && MinSpin <= MaxSpin, "Invalid spin bounds.");
+
+    std::uint32_t cur_{MinSpin};
+
+  public:
+    void operator()() {
+      if (YieldOnMax && cur_ >= MaxSpin) {
+        std::this_thread::yield();
+        return;
+      }
+      std::uint32_t spin{cur_ / 2 + fast_random() % (cur_ - cur_ / 2)};
+      for (std::uint32_t i = 0; i < spin; i++) {
+        cpu_relax();
+      }
+      cur_ = std::min(cur_ * 2, MaxSpin);
+    }
+
+    void reset() {
+      cur_ = MinSpin;
+    }
+  };
+
   template<typename ValType>
   using DefaultDeleter = std::default_delete<std::remove_pointer_t<ValType>>;
 
+  /**
+   * @brief 通过 Allocator 析构并归还对象的 deleter.
+   *
+   * 与 `std::allocator_traits<Allocator>::allocate` + `construct` 配对使用.
+   * 无状态的 Allocator (如 `std::allocator`) 为空类型, 可被 `EBODeleterStorage` 优化掉.
+   *
+   * @tparam ValType 受管理的类型, 与 `DefaultDeleter` 一致, 允许传入指针类型.
+   * @tparam Allocator 任意 Allocator, 内部 rebind 到 `ValType`.
+   */
+  template<typename ValType, typename Allocator = std::allocator<std::remove_pointer_t<ValType>>>
+  class AllocatorDeleter
+      : private std::allocator_traits<Allocator>::template rebind_alloc<std::remove_pointer_t<ValType>> {
+  private:
+    using Pointee_ = std::remove_pointer_t<ValType>;
+    using Alloc_ = typename std::allocator_traits<Allocator>::template rebind_alloc<Pointee_>;
+    using AllocTraits_ = std::allocator_traits<Alloc_>;
+
+  public:
+    AllocatorDeleter() = default;
+    AllocatorDeleter(const Allocator &alloc) : Alloc_{alloc} {
+    }
+
+    auto get_allocator() -> Alloc_ & {
+      return *this;
+    }
+
+    void operator()(Pointee_ *ptr) {
+      AllocTraits_::destroy(get_allocator(), ptr);
+      AllocTraits_::deallocate(get_allocator(), ptr, 1);
+    }
+  };
+
   template<typename DeleterType, typename Requires = void>
   class EBODeleterStorage {
   private:
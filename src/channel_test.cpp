@@ -0,0 +1,185 @@
+#include "SimpleCU_Channel.h"
+#include "SimpleCU_ThreadPool.h"
+#include <bits/stdc++.h>
+
+#define THREAD_CNT (std::max(4u, std::thread::hardware_concurrency()))
+#define ORDER_SCALE 1000000ul
+#define VALTAG_SCALE 2000000ul
+#define FAST_PATH_SCALE 10000000ul
+#define SMALL_CAPACITY 16ul
+
+/**
+ * 本线程的分配计数, 用于确认快速路径不分配内存. 线程池的工作线程可能同时分配, 因此按线程计数.
+ */
+thread_local std::size_t alloc_cnt{};
+
+auto operator new(std::size_t size) -> void * {
+  alloc_cnt++;
+  if (void *ptr{std::malloc(size ? size : 1)}) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+/**
+ * 立即开始执行, 结束时自行销毁的协程.
+ */
+struct Detached {
+  struct promise_type {
+    auto get_return_object() -> Detached {
+      return {};
+    }
+
+    auto initial_suspend() -> std::suspend_never {
+      return {};
+    }
+
+    auto final_suspend() noexcept -> std::suspend_never {
+      return {};
+    }
+
+    void return_void() {
+    }
+
+    void unhandled_exception() {
+      std::terminate();
+    }
+  };
+};
+
+/**
+ * 把恢复作为 `TaskGroup` 的任务提交, `wait` 返回时所有协程都已结束.
+ */
+struct GroupExecutor {
+  SimpleCU::TaskGroup *group_;
+
+  template<typename Fn>
+  void submit(Fn &&fn) {
+    group_->run(std::forward<Fn>(fn));
+  }
+};
+
+template<typename Channel>
+auto produce(Channel &ch, std::size_t beg, std::size_t end) -> Detached {
+  for (std::size_t i = beg; i < end; i++) {
+    co_await ch.send(i);
+  }
+}
+
+auto consume_in_order(SimpleCU::Channel<std::size_t, SimpleCU::InlineExecutor> &ch, bool &passed) -> Detached {
+  for (std::size_t i = 0; i < ORDER_SCALE; i++) {
+    passed &= co_await ch.recv() == i;
+  }
+}
+
+/**
+ * 单生产者单消费者, 容量很小, 两个协程在同一线程上交替挂起. 取出的顺序应与发送一致.
+ */
+void order_test() {
+  SimpleCU::InlineExecutor executor{};
+  SimpleCU::Channel<std::size_t, SimpleCU::InlineExecutor> ch{4, executor};
+  bool passed{true};
+  consume_in_order(ch, passed);
+  produce(ch, 0, ORDER_SCALE);
+  passed &= !ch.try_recv().has_value();
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+auto consume(SimpleCU::Channel<std::size_t, GroupExecutor> &ch, std::vector<int> &valtag, std::size_t cnt)
+    -> Detached {
+  for (std::size_t i = 0; i < cnt; i++) {
+    valtag[co_await ch.recv()]++;
+  }
+}
+
+/**
+ * 线程池上多个生产者协程与多个消费者协程, 容量很小使双方频繁挂起. 每个值恰好取出一次.
+ */
+void mpmc_test(SimpleCU::ThreadPool &pool) {
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  SimpleCU::TaskGroup group{pool};
+  GroupExecutor executor{&group};
+  SimpleCU::Channel<std::size_t, GroupExecutor> ch{SMALL_CAPACITY, executor};
+  std::size_t coro_cnt{THREAD_CNT};
+  std::size_t blksz{(VALTAG_SCALE + coro_cnt - 1) / coro_cnt};
+  for (std::size_t i = 0; i < coro_cnt; i++) {
+    std::size_t beg{blksz * i};
+    std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+    group.run([&ch, &valtag, beg, end]() { consume(ch, valtag, end - beg); });
+    group.run([&ch, beg, end]() { produce(ch, beg, end); });
+  }
+  group.wait();
+
+  bool passed{std::ranges::all_of(valtag, [](int v) { return v == 1; }) && !ch.try_recv().has_value()};
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 在调用方线程上直接执行, 并记录提交次数. 只有挂起的协程被恢复时才会提交.
+ */
+struct CountingExecutor {
+  std::size_t submit_cnt_{};
+
+  template<typename Fn>
+  void submit(Fn &&fn) {
+    submit_cnt_++;
+    std::forward<Fn>(fn)();
+  }
+};
+
+struct EchoResult {
+  std::size_t sum_{};
+  std::size_t alloc_cnt_{};
+  bool done_{};
+};
+
+auto echo(SimpleCU::Channel<std::size_t, CountingExecutor> &ch, EchoResult &res) -> Detached {
+  std::size_t alloc_beg{alloc_cnt};
+  for (std::size_t i = 0; i < FAST_PATH_SCALE; i++) {
+    co_await ch.send(i);
+    res.sum_ += co_await ch.recv();
+  }
+  res.alloc_cnt_ = alloc_cnt - alloc_beg;
+  res.done_ = true;
+}
+
+/**
+ * 单个协程交替 `send` / `recv`, 缓冲区中只有 0 或 1 个元素, `send` / `recv` 都不应挂起.
+ * `echo` 返回时已执行完毕说明没有挂起 (无人恢复), 执行器没有收到提交, 循环期间也没有分配内存.
+ */
+void fast_path_test() {
+  CountingExecutor executor{};
+  SimpleCU::Channel<std::size_t, CountingExecutor> ch{SMALL_CAPACITY, executor};
+  EchoResult res{};
+  echo(ch, res);
+  bool passed{res.done_ && executor.submit_cnt_ == 0 && res.alloc_cnt_ == 0};
+  passed &= res.sum_ == FAST_PATH_SCALE * (FAST_PATH_SCALE - 1) / 2;
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+int main() {
+  auto beg0{std::chrono::high_resolution_clock::now()};
+  order_test();
+  auto end0{std::chrono::high_resolution_clock::now()};
+  std::cout << end0 - beg0 << std::endl;
+
+  SimpleCU::ThreadPool pool{THREAD_CNT};
+
+  auto beg1{std::chrono::high_resolution_clock::now()};
+  mpmc_test(pool);
+  auto end1{std::chrono::high_resolution_clock::now()};
+  std::cout << end1 - beg1 << std::endl;
+
+  auto beg2{std::chrono::high_resolution_clock::now()};
+  fast_path_test();
+  auto end2{std::chrono::high_resolution_clock::now()};
+  std::cout << end2 - beg2 << std::endl;
+}
@@ -0,0 +1,180 @@
+#include "SimpleCU_RCUHashMap.h"
+#include <bits/stdc++.h>
+
+#define MAX_THREAD_CNT 256u
+#define THREAD_CNT (std::clamp(std::thread::hardware_concurrency(), 4u, MAX_THREAD_CNT))
+#define MAP_SCALE 1000000ul
+#define STABLE_SCALE 100000ul
+#define LOOKUP_SCALE 4000000ul
+
+template<typename Key, typename ValType>
+using RCUHashMap = SimpleCU::RCUHashMap<Key, ValType, std::hash<Key>, std::equal_to<Key>,
+                                        SimpleCU::Reclaim::QSBRPolicy<MAX_THREAD_CNT + 1>>; // 另加主线程
+
+/**
+ * 以 `std::shared_mutex` 保护的 `std::unordered_map`, 作为对照.
+ */
+template<typename Key, typename ValType>
+class SharedMutexMap {
+private:
+  std::shared_mutex mtx_;
+  std::unordered_map<Key, ValType> map_;
+
+public:
+  auto insert(const Key &key, const ValType &val) -> bool {
+    std::unique_lock lock{mtx_};
+    return map_.emplace(key, val).second;
+  }
+
+  auto erase(const Key &key) -> bool {
+    std::unique_lock lock{mtx_};
+    return map_.erase(key) == 1;
+  }
+
+  auto find(const Key &key) -> std::optional<ValType> {
+    std::shared_lock lock{mtx_};
+    auto iter{map_.find(key)};
+    return iter == map_.end() ? std::nullopt : std::make_optional(iter->second);
+  }
+};
+
+/**
+ * 单线程随机操作, 与 `std::unordered_map` 对照. 初始 2 个桶, 过程中反复扩容.
+ */
+void basic_test() {
+  RCUHashMap<std::uint64_t, std::uint64_t> map{2};
+  std::unordered_map<std::uint64_t, std::uint64_t> ref{};
+  bool passed{true};
+  for (std::size_t i = 0; i < MAP_SCALE; i++) {
+    std::uint64_t key{SimpleCU::Utils::fast_random() % (MAP_SCALE / 2)};
+    switch (i % 4) {
+      case 0:
+      case 1:
+        passed &= map.insert(key, key + i) == ref.emplace(key, key + i).second;
+        break;
+      case 2:
+        passed &= map.insert_or_assign(key, i) == !ref.contains(key);
+        ref[key] = i;
+        break;
+      default:
+        passed &= map.erase(key) == (ref.erase(key) == 1);
+    }
+  }
+  for (std::uint64_t key = 0; key < MAP_SCALE / 2; key++) {
+    auto iter{ref.find(key)};
+    passed &= map.find(key) == (iter == ref.end() ? std::nullopt : std::make_optional(iter->second));
+  }
+  passed &= map.size() == ref.size();
+  std::cout << (passed ? "passed" : "failed") << " buckets " << map.bucket_cnt() << std::endl;
+}
+
+/**
+ * 预先插入的键在写者插入 / 删除其他键并触发多轮扩容期间, 读者应始终能找到且值正确.
+ */
+void resize_test() {
+  RCUHashMap<std::uint64_t, std::uint64_t> map{16};
+  for (std::uint64_t key = 0; key < STABLE_SCALE; key++) {
+    map.insert(key, key * 3);
+  }
+  std::size_t thread_cnt{THREAD_CNT};
+  std::size_t writer_cnt{thread_cnt / 2};
+  std::atomic<bool> done{};
+  std::atomic<bool> passed{true};
+
+  std::barrier b{THREAD_CNT};
+  std::vector<std::jthread> js(thread_cnt);
+  for (std::size_t i = 0; i < writer_cnt; i++) {
+    js[i] = std::jthread{[&map, &passed, &b, writer_cnt, i]() {
+      b.arrive_and_wait();
+      for (std::uint64_t j = 0; j < MAP_SCALE / writer_cnt; j++) {
+        std::uint64_t key{STABLE_SCALE + j * writer_cnt + i};
+        bool ok{map.insert(key, key) && map.find(key) == key};
+        if (j % 2 == 1) {
+          ok &= map.erase(key) && !map.contains(key);
+        }
+        if (!ok) {
+          passed.store(false, std::memory_order_relaxed);
+        }
+      }
+    }};
+  }
+  for (std::size_t i = writer_cnt; i < thread_cnt; i++) {
+    js[i] = std::jthread{[&map, &done, &passed, &b]() {
+      b.arrive_and_wait();
+      while (!done.load(std::memory_order_acquire)) {
+        std::uint64_t key{SimpleCU::Utils::fast_random() % STABLE_SCALE};
+        if (map.find(key) != key * 3) {
+          passed.store(false, std::memory_order_relaxed);
+        }
+      }
+    }};
+  }
+  for (std::size_t i = 0; i < writer_cnt; i++) {
+    js[i].join();
+  }
+  done.store(true, std::memory_order_release);
+  js.clear();
+
+  bool all_found{true};
+  for (std::uint64_t j = 0; j < MAP_SCALE / writer_cnt * writer_cnt; j++) {
+    all_found &= map.contains(STABLE_SCALE + j) == ((j / writer_cnt) % 2 == 0);
+  }
+  std::cout << (passed.load() && all_found ? "passed" : "failed") << " buckets " << map.bucket_cnt() << std::endl;
+}
+
+/**
+ * 读多写少: 每个线程 1/32 的操作为插入或删除.
+ */
+template<typename Map>
+void read_mostly_test() {
+  Map map{};
+  for (std::uint64_t key = 0; key < STABLE_SCALE; key++) {
+    map.insert(key, key);
+  }
+  std::size_t thread_cnt{THREAD_CNT};
+  std::atomic<std::size_t> hits{};
+
+  std::barrier b{THREAD_CNT};
+  std::vector<std::jthread> js(thread_cnt);
+  for (std::size_t i = 0; i < thread_cnt; i++) {
+    js[i] = std::jthread{[&map, &hits, &b, thread_cnt]() {
+      b.arrive_and_wait();
+      std::size_t local_hits{};
+      for (std::size_t j = 0; j < LOOKUP_SCALE / thread_cnt; j++) {
+        std::uint64_t key{SimpleCU::Utils::fast_random() % (STABLE_SCALE * 2)};
+        if (j % 32 == 0) {
+          map.insert(key, key);
+        } else if (j % 32 == 16) {
+          map.erase(key);
+        } else {
+          local_hits += map.find(key).has_value();
+        }
+      }
+      hits.fetch_add(local_hits, std::memory_order_relaxed);
+    }};
+  }
+  js.clear();
+  std::cout << hits.load() << std::endl;
+}
+
+int main() {
+  auto beg0{std::chrono::high_resolution_clock::now()};
+  basic_test();
+  auto end0{std::chrono::high_resolution_clock::now()};
+  std::cout << end0 - beg0 << std::endl;
+
+  auto beg1{std::chrono::high_resolution_clock::now()};
+  resize_test();
+  auto end1{std::chrono::high_resolution_clock::now()};
+  std::cout << end1 - beg1 << std::endl;
+
+  auto beg2{std::chrono::high_resolution_clock::now()};
+  read_mostly_test<RCUHashMap<std::uint64_t, std::uint64_t>>();
+  auto end2{std::chrono::high_resolution_clock::now()};
+  std::cout << end2 - beg2 << std::endl;
+
+  auto beg3{std::chrono::high_resolution_clock::now()};
+  read_mostly_test<SharedMutexMap<std::uint64_t, std::uint64_t>>();
+  auto end3{std::chrono::high_resolution_clock::now()};
+  std::cout << end3 - beg3 << std::endl;
+}
@@ -1,75 +1,24 @@
-#include "SimpleCU_HazPtr.h"
+#include "SimpleCU_FlatCombining.h"
+#include "SimpleCU_LockFreeStack.h"
 #include <bits/stdc++.h>
 #include <boost/lockfree/stack.hpp>
 
-template<typename ValType>
-class LockFreeStack {
-private:
-  struct Node {
-    ValType val_;
-    Node *next_;
-    Node(const ValType &val) : val_{val} {
-    }
-  };
-  std::atomic<Node *> head_;
-  SimpleCU::HazPtr::HazPtrManager<Node, 20, 1> hazptr_manager_;
-
-public:
-  void push(const ValType &val) {
-    Node *new_node{new Node{val}};
-    Node *expected = head_.load(std::memory_order_relaxed);
-    new_node->next_ = expected;
-    while (!head_.compare_exchange_weak(expected, new_node, std::memory_order_release, std::memory_order_relaxed)) {
-      new_node->next_ = expected;
-    }
-  }
+#define PARA_CNT (20)
 
-  std::optional<ValType> pop() {
-    Node *old_head{head_.load(std::memory_order_relaxed)};
-    do {
-      Node *tmp{};
-      do {
-        tmp = old_head;
-        hazptr_manager_.set_hazptr(0,
-                                   old_head);             // (1) seq_cst store 保证不和 (2) 乱序
-        old_head = head_.load(std::memory_order_seq_cst); // (2) seq_cst 必须读到最新值, 来判断 `head_` 这期间没有变化
-      } while (old_head != tmp);
-      // 如果 `head_` 已经被其他线程 CAS 修改, 还允许 `old_head` 读到旧值, 错误判断 `head_` 没变,
-      // `old_head` 可能早在当前线程设置 hazard pointer 之前就被 delete,
-      // CAS `old_head->next_` use after free
-    } while (old_head && !head_.compare_exchange_weak(old_head, old_head->next_, std::memory_order_seq_cst,
-                                                      std::memory_order_relaxed));
-
-    hazptr_manager_.unset_hazptr(0); // release
-
-    if (!old_head) {
-      return std::nullopt;
-    }
+template<typename ValType, typename Backoff = SimpleCU::Utils::NoBackoff>
+using LockFreeStack = SimpleCU::LockFreeStack<ValType, SimpleCU::Reclaim::HazPtrPolicy<PARA_CNT, 1>,
+                                              SimpleCU::Utils::PoolAllocator<ValType>, Backoff>;
 
-    ValType ret{std::move(old_head->val_)};
-    if (hazptr_manager_.get_retired_cnt_local() >= 2 * hazptr_manager_.get_max_hazptr_cnt_global()) {
-      if (hazptr_manager_.check_hazptr(old_head)) { // acquire
-        hazptr_manager_.retire(old_head);
-      } else {
-        delete old_head;
-      }
-    } else {
-      hazptr_manager_.retire(old_head);
-    }
-    hazptr_manager_.reclaim_local();
-    return std::make_optional(std::move(ret));
-  }
-};
-
-#define PARA_CNT (20)
 #define VALTAG_SCALE 5000000ul
+#define CHURN_ROUNDS 32ul
 
 std::size_t PUSH_PARA_CNT{15};
 std::size_t POP_PARA_CNT{5};
 
+template<typename Stack = LockFreeStack<int>>
 void lockfree_stack_test() {
   std::vector<int> valtag(VALTAG_SCALE, 0);
-  LockFreeStack<int> stack{};
+  Stack stack{};
 
   std::barrier b{PARA_CNT};
   std::vector<std::jthread> js(PARA_CNT);
@@ -227,13 +176,63 @@ void boost_stack_test() {
   std::cout << checksum << std::endl;
 }
 
+/**
+ * 先后共 `CHURN_ROUNDS * (PARA_CNT - 1)` 个线程使用同一个 `FCStack`, 远多于记录数 (主线程占用一个).
+ * 每轮线程退出后记录被下一轮复用, 所有线程都应经发布记录合并执行, 每个元素恰好取出一次.
+ */
+void fc_churn_test() {
+  std::size_t round_cnt{PARA_CNT - 1};
+  std::size_t per_thread{VALTAG_SCALE / CHURN_ROUNDS / round_cnt};
+  std::vector<int> valtag(per_thread * round_cnt * CHURN_ROUNDS, 0);
+  SimpleCU::FCStack<int, PARA_CNT> stack{};
+  bool passed{stack.has_record()};
+  std::atomic<bool> combined{true};
+
+  for (std::size_t r = 0; r < CHURN_ROUNDS; r++) {
+    std::vector<std::jthread> js(round_cnt);
+    for (std::size_t i = 0; i < round_cnt; i++) {
+      js[i] = std::jthread{[&valtag, &stack, &combined, per_thread, beg = (r * round_cnt + i) * per_thread]() {
+        if (!stack.has_record()) {
+          combined.store(false, std::memory_order_relaxed);
+        }
+        for (std::size_t j = beg; j < beg + per_thread; j++) {
+          stack.push(static_cast<int>(j));
+          if (std::optional<int> res{stack.pop()}; res.has_value()) {
+            valtag[res.value()]++;
+          }
+        }
+      }};
+    }
+  }
+  while (std::optional<int> res{stack.pop()}) {
+    valtag[res.value()]++;
+  }
+  passed &= combined.load(std::memory_order_relaxed) && std::ranges::all_of(valtag, [](int v) { return v == 1; });
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
 int main() {
 
+  auto beg0{std::chrono::high_resolution_clock::now()};
+  lockfree_stack_test<LockFreeStack<int, SimpleCU::Utils::ExpBackoff<>>>();
+  auto end0{std::chrono::high_resolution_clock::now()};
+  std::cout << end0 - beg0 << std::endl;
+
   auto beg2{std::chrono::high_resolution_clock::now()};
   lockfree_stack_test();
   auto end2{std::chrono::high_resolution_clock::now()};
   std::cout << end2 - beg2 << std::endl;
 
+  auto beg4{std::chrono::high_resolution_clock::now()};
+  lockfree_stack_test<SimpleCU::FCStack<int, PARA_CNT>>();
+  auto end4{std::chrono::high_resolution_clock::now()};
+  std::cout << end4 - beg4 << std::endl;
+
+  auto beg5{std::chrono::high_resolution_clock::now()};
+  fc_churn_test();
+  auto end5{std::chrono::high_resolution_clock::now()};
+  std::cout << end5 - beg5 << std::endl;
+
   auto beg1{std::chrono::high_resolution_clock::now()};
   normal_stack_test();
   auto end1{std::chrono::high_resolution_clock::now()};
@@ -0,0 +1,62 @@
+#include "SimpleCU_HazPtr.h"
+#include "SimpleCU_QSBR.h"
+#include <bits/stdc++.h>
+
+#define PARA_CNT (20)
+#define INC_SCALE 20000000ul
+
+using SimpleCU::Utils::PaddingProfile;
+
+static_assert(SimpleCU::Utils::is_padded_v<SimpleCU::Utils::Aligned<std::atomic<int>, PaddingProfile::Line128>,
+                                           PaddingProfile::Line128>);
+static_assert(sizeof(SimpleCU::Utils::Aligned<std::atomic<int>, PaddingProfile::None>) == sizeof(std::atomic<int>));
+
+/**
+ * 每个线程只写自己的计数器, 计数器之间只隔着 `Profile` 要求的填充.
+ * 若相邻计数器落在同一 cacheline (或同一对相邻行) 上, 耗时会明显上升.
+ */
+template<PaddingProfile Profile>
+void false_sharing_test(const char *name) {
+  using Counter = SimpleCU::Utils::Aligned<std::atomic<std::uint64_t>, Profile>;
+  static_assert(SimpleCU::Utils::is_padded_v<Counter, Profile>);
+
+  std::unique_ptr<std::array<Counter, PARA_CNT>> counters{std::make_unique<std::array<Counter, PARA_CNT>>()};
+
+  std::barrier b{PARA_CNT};
+  std::vector<std::jthread> js(PARA_CNT);
+
+  auto beg{std::chrono::high_resolution_clock::now()};
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i] = std::jthread{[&counters, &b, i]() {
+      b.arrive_and_wait();
+      Counter &counter{(*counters)[i]};
+      for (std::size_t j = 0; j < INC_SCALE; j++) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+    }};
+  }
+
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i].join();
+  }
+  auto end{std::chrono::high_resolution_clock::now()};
+
+  bool passed{true};
+  for (int i = 0; i < PARA_CNT; i++) {
+    passed = passed && (*counters)[i].load() == INC_SCALE;
+  }
+  std::cout << name << " (" << sizeof(Counter) << "B): " << (passed ? "passed" : "failed") << std::endl;
+  std::cout << end - beg << std::endl;
+}
+
+int main() {
+  // 布局检查随模板实例化生效.
+  SimpleCU::QSBR::QSBRManager<PARA_CNT, int *, SimpleCU::Utils::DefaultDeleter<int *>, PaddingProfile::Line128> qsbr{};
+  SimpleCU::HazPtr::HazPtrManager<int, PARA_CNT, 2, SimpleCU::Utils::DefaultDeleter<int>, PaddingProfile::Line128>
+      hazptr{};
+
+  false_sharing_test<PaddingProfile::None>("None");
+  false_sharing_test<PaddingProfile::Line64>("Line64");
+  false_sharing_test<PaddingProfile::Line128>("Line128");
+  false_sharing_test<PaddingProfile::Destructive>("Destructive");
+}
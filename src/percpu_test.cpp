@@ -0,0 +1,111 @@
+#include "SimpleCU_PerCPU.h"
+#include <bits/stdc++.h>
+
+#define PARA_CNT (20)
+#define ADD_SCALE 2000000ul
+#define SLOT_SCALE 1000000ul
+
+template<typename Counter, typename AddFunc>
+void counter_test(AddFunc &&add) {
+  Counter counter{};
+
+  std::barrier b{PARA_CNT};
+  std::vector<std::jthread> js(PARA_CNT);
+
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i] = std::jthread{[&counter, &b, &add]() {
+      b.arrive_and_wait();
+      for (std::size_t j = 0; j < ADD_SCALE; j++) {
+        add(counter);
+      }
+    }};
+  }
+
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i].join();
+  }
+
+  bool passed{static_cast<std::size_t>(counter.load()) == PARA_CNT * ADD_SCALE};
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+void sharded_counter_test() {
+  counter_test<SimpleCU::Utils::ShardedCounter>([](SimpleCU::Utils::ShardedCounter &c) { c.add(1); });
+}
+
+void atomic_counter_test() {
+  counter_test<std::atomic<std::intptr_t>>(
+      [](std::atomic<std::intptr_t> &c) { c.fetch_add(1, std::memory_order_relaxed); });
+}
+
+/**
+ * 每个线程先放入自己的对象, 之后不断取出再放回. 同一对象不能同时被两个线程取出, 也不能丢失.
+ */
+void percpu_slots_test() {
+  struct Obj {
+    std::atomic<bool> in_use_;
+  };
+  constexpr std::size_t obj_per_thread{8};
+  std::vector<Obj> objs(PARA_CNT * obj_per_thread);
+  SimpleCU::Utils::PerCPUSlots<Obj, PARA_CNT * obj_per_thread> slots{};
+  std::atomic<bool> broken{};
+
+  std::barrier b{PARA_CNT};
+  std::vector<std::jthread> js(PARA_CNT);
+
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i] = std::jthread{[&objs, &slots, &broken, &b, i]() {
+      for (std::size_t j = 0; j < obj_per_thread; j++) {
+        if (!slots.try_push(&objs[i * obj_per_thread + j])) {
+          broken.store(true);
+        }
+      }
+      b.arrive_and_wait();
+      for (std::size_t j = 0; j < SLOT_SCALE; j++) {
+        Obj *obj{slots.try_pop()};
+        if (!obj) {
+          continue;
+        }
+        if (obj->in_use_.exchange(true)) {
+          broken.store(true);
+        }
+        obj->in_use_.store(false);
+        if (!slots.try_push(obj)) {
+          broken.store(true);
+        }
+      }
+    }};
+  }
+
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i].join();
+  }
+
+  // 单线程取回时不一定位于原 CPU, 逐个 CPU 迁移不可控, 这里只检查取回的对象无重复.
+  std::unordered_set<Obj *> seen{};
+  Obj *obj{};
+  while ((obj = slots.try_pop()) != nullptr) {
+    if (!seen.insert(obj).second) {
+      broken.store(true);
+    }
+  }
+  std::cout << (!broken.load() ? "passed" : "failed") << std::endl;
+}
+
+int main() {
+
+  auto beg1{std::chrono::high_resolution_clock::now()};
+  sharded_counter_test();
+  auto end1{std::chrono::high_resolution_clock::now()};
+  std::cout << end1 - beg1 << std::endl;
+
+  auto beg2{std::chrono::high_resolution_clock::now()};
+  atomic_counter_test();
+  auto end2{std::chrono::high_resolution_clock::now()};
+  std::cout << end2 - beg2 << std::endl;
+
+  auto beg3{std::chrono::high_resolution_clock::now()};
+  percpu_slots_test();
+  auto end3{std::chrono::high_resolution_clock::now()};
+  std::cout << end3 - beg3 << std::endl;
+}
@@ -1,101 +1,37 @@
-#include "SimpleCU_QSBR.h"
+#include "SimpleCU_Blocking.h"
+#include "SimpleCU_LockFreeStack.h"
+#include "SimpleCU_TaggedStack.h"
 // #include "SingleHeader_SimpleCU_QSBR.h"
 #include <bits/stdc++.h>
 #include <boost/lockfree/stack.hpp>
 
-template<typename ValType>
-class LockFreeStack {
-private:
-  struct Node {
-    ValType val_;
-    Node *next_;
-    Node(const ValType &val) : val_{val} {
-    }
-  };
-  std::atomic<Node *> head_;
-  // SimpleCU::HazPtr::HazPtrManager<Node, 20, 1> hazptr_manager_;
-  SimpleCU::QSBR::QSBRManager<20, Node *> qsbr_mgr_;
-
-public:
-  void push(const ValType &val) {
-    Node *new_node{new Node{val}};
-    Node *expected = head_.load(std::memory_order_relaxed);
-    new_node->next_ = expected;
-    while (!head_.compare_exchange_weak(expected, new_node, std::memory_order_release, std::memory_order_relaxed)) {
-      new_node->next_ = expected;
-    }
-  }
+#define PARA_CNT (20)
 
-  // std::optional<ValType> pop() {
-  //   Node *old_head{head_.load(std::memory_order_relaxed)};
-  //   do {
-  //     Node *tmp{};
-  //     do {
-  //       tmp = old_head;
-  //       hazptr_manager_.set_hazptr(0,
-  //                                  old_head);             // (1) seq_cst store 保证不和 (2) 乱序
-  //       old_head = head_.load(std::memory_order_seq_cst); // (2) seq_cst 必须读到最新值, 来判断 `head_`
-  //       这期间没有变化
-  //     } while (old_head != tmp);
-  //     // 如果 `head_` 已经被其他线程 CAS 修改, 还允许 `old_head` 读到旧值, 错误判断 `head_` 没变,
-  //     // `old_head` 可能早在当前线程设置 hazard pointer 之前就被 delete,
-  //     // CAS `old_head->next_` use after free
-  //   } while (old_head && !head_.compare_exchange_weak(old_head, old_head->next_, std::memory_order_seq_cst,
-  //                                                     std::memory_order_relaxed));
-
-  //   hazptr_manager_.unset_hazptr(0); // release
-
-  //   if (!old_head) {
-  //     return std::nullopt;
-  //   }
-
-  //   ValType ret{std::move(old_head->val_)};
-  //   if (hazptr_manager_.get_retired_cnt_local() >= 2 * hazptr_manager_.get_max_hazptr_cnt_global()) {
-  //     if (hazptr_manager_.check_hazptr(old_head)) { // acquire
-  //       hazptr_manager_.retire(old_head);
-  //     } else {
-  //       delete old_head;
-  //     }
-  //   } else {
-  //     hazptr_manager_.retire(old_head);
-  //   }
-  //   hazptr_manager_.reclaim_local();
-  //   return std::make_optional(std::move(ret));
-  // }
-
-  auto pop() -> std::optional<ValType> {
-
-    Node *old_head{};
-    qsbr_mgr_.enter_critical_zone();
-    old_head = head_.load(std::memory_order_acquire);
-    do {
-    } while (old_head && !head_.compare_exchange_weak(old_head, old_head->next_, std::memory_order_acquire,
-                                                      std::memory_order_acquire));
-    qsbr_mgr_.exit_critical_zone();
-
-    if (!old_head) {
-      return std::nullopt;
-    }
+template<typename ValType, typename Backoff = SimpleCU::Utils::NoBackoff, std::size_t EliminationWidth = 0>
+using LockFreeStack = SimpleCU::LockFreeStack<ValType, SimpleCU::Reclaim::QSBRPolicy<PARA_CNT>,
+                                              SimpleCU::Utils::PoolAllocator<ValType>, Backoff, EliminationWidth>;
 
-    ValType ret{std::move(old_head->val_)};
-    qsbr_mgr_.retire(std::move(old_head));
-    if (qsbr_mgr_.get_retired_cnt_local() > 32) {
-      qsbr_mgr_.reclaim_local();
-    }
+template<typename ValType>
+using HazPtrLockFreeStack = SimpleCU::LockFreeStack<ValType, SimpleCU::Reclaim::HazPtrPolicy<PARA_CNT, 1>,
+                                                    SimpleCU::Utils::PoolAllocator<ValType>>;
 
-    return std::make_optional(std::move(ret));
-  }
-};
+/**
+ * 不回收节点, 内存随 arena 一起释放.
+ */
+template<typename ValType>
+using ArenaLockFreeStack = SimpleCU::LockFreeStack<ValType, SimpleCU::Reclaim::LeakPolicy,
+                                                   std::pmr::polymorphic_allocator<ValType>>;
 
-#define PARA_CNT (20)
 #define VALTAG_SCALE 5000000ul
+#define CHURN_ROUNDS 32ul
 
 std::size_t PUSH_PARA_CNT{15};
 std::size_t POP_PARA_CNT{5};
 
-void lockfree_stack_test() {
+template<typename Stack = LockFreeStack<int>, typename... Args>
+void lockfree_stack_test(Args &&...args) {
   std::vector<int> valtag(VALTAG_SCALE, 0);
-  LockFreeStack<int> stack{};
+  Stack stack{std::forward<Args>(args)...};
 
   std::barrier b{PARA_CNT};
   std::vector<std::jthread> js(PARA_CNT);
@@ -145,6 +81,235 @@ void lockfree_stack_test() {
   std::cout << checksum << std::endl;
 }
 
+/**
+ * 元素只能移动且不可默认构造, push 与 emplace 交替使用.
+ */
+void move_only_stack_test() {
+  struct Payload {
+    std::unique_ptr<int> val_;
+    Payload(int val) : val_{std::make_unique<int>(val)} {
+    }
+  };
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  LockFreeStack<Payload> stack{};
+
+  std::barrier b{PARA_CNT};
+  std::vector<std::jthread> js(PARA_CNT);
+
+  for (int i = 0; i < PUSH_PARA_CNT; i++) {
+    js[i] = std::jthread{[&stack, &b, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + PUSH_PARA_CNT - 1) / PUSH_PARA_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (int i = beg; i < end; i++) {
+        if (i & 1) {
+          stack.push(Payload{i});
+        } else {
+          stack.emplace(i);
+        }
+      }
+    }};
+  }
+
+  for (int i = 0; i < POP_PARA_CNT; i++) {
+    js[PUSH_PARA_CNT + i] = std::jthread{[&valtag, &stack, &b, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + POP_PARA_CNT - 1) / POP_PARA_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (int i = beg; i < end;) {
+        std::optional<Payload> res{stack.pop()};
+        if (res.has_value()) {
+          i++;
+          valtag[*res.value().val_] = 1;
+        }
+      }
+    }};
+  }
+
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i].join();
+  }
+
+  bool passed{true};
+  for (int i = 0; i < VALTAG_SCALE; i++) {
+    if (valtag[i] != 1) {
+      passed = false;
+      break;
+    }
+  }
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 先后共 `CHURN_ROUNDS * (PARA_CNT - 1)` 个线程使用同一个栈, 远多于回收策略的上下文数.
+ * 主线程先 `pop` 一次进入回收域, 全程占用一个上下文. 每轮的线程在 barrier 处同时存活, 恰好用满其余上下文.
+ * 每轮线程退出后上下文被下一轮复用, 每个元素恰好取出一次.
+ */
+template<typename Stack>
+void thread_churn_test() {
+  std::size_t round_cnt{PARA_CNT - 1};
+  std::size_t per_thread{VALTAG_SCALE / CHURN_ROUNDS / round_cnt};
+  std::vector<int> valtag(per_thread * round_cnt * CHURN_ROUNDS, 0);
+  Stack stack{};
+  bool passed{!stack.pop().has_value()}; // 进入回收域, 主线程登记上下文
+
+  for (std::size_t r = 0; r < CHURN_ROUNDS; r++) {
+    std::barrier b{static_cast<std::ptrdiff_t>(round_cnt)};
+    std::vector<std::jthread> js(round_cnt);
+    for (std::size_t i = 0; i < round_cnt; i++) {
+      js[i] = std::jthread{[&valtag, &stack, &b, per_thread, beg = (r * round_cnt + i) * per_thread]() {
+        for (std::size_t j = beg; j < beg + per_thread; j++) {
+          stack.push(static_cast<int>(j));
+          if (std::optional<int> res{stack.pop()}; res.has_value()) {
+            valtag[res.value()]++;
+          }
+        }
+        b.arrive_and_wait();
+      }};
+    }
+  }
+  while (std::optional<int> res{stack.pop()}) {
+    valtag[res.value()]++;
+  }
+  passed &= std::ranges::all_of(valtag, [](int v) { return v == 1; });
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * pop 线程使用 `wait_pop`. push 开始前先空闲一段时间, 输出这期间整个进程消耗的 CPU 时间.
+ */
+void blocking_stack_test() {
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  SimpleCU::Blocking<LockFreeStack<int>> stack{};
+
+  std::barrier b{static_cast<std::ptrdiff_t>(PUSH_PARA_CNT + 1)};
+  std::latch poppers_ready{static_cast<std::ptrdiff_t>(POP_PARA_CNT)};
+  std::vector<std::jthread> js(PARA_CNT);
+
+  for (int i = 0; i < PUSH_PARA_CNT; i++) {
+    js[i] = std::jthread{[&stack, &b, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + PUSH_PARA_CNT - 1) / PUSH_PARA_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (int i = beg; i < end; i++) {
+        stack.push(i);
+      }
+    }};
+  }
+
+  for (int i = 0; i < POP_PARA_CNT; i++) {
+    js[PUSH_PARA_CNT + i] = std::jthread{[&valtag, &stack, &poppers_ready, i]() {
+      poppers_ready.count_down();
+      std::size_t blksz{(VALTAG_SCALE + POP_PARA_CNT - 1) / POP_PARA_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (int i = beg; i < end; i++) {
+        valtag[stack.wait_pop()] = 1;
+      }
+    }};
+  }
+
+  poppers_ready.wait();
+  std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  std::clock_t cpu_beg{std::clock()};
+  std::this_thread::sleep_for(std::chrono::milliseconds{200});
+  std::clock_t cpu_end{std::clock()};
+  b.arrive_and_wait();
+
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i].join();
+  }
+
+  bool passed{!stack.try_pop_for(std::chrono::milliseconds{1}).has_value()};
+  for (int i = 0; i < VALTAG_SCALE; i++) {
+    if (valtag[i] != 1) {
+      passed = false;
+      break;
+    }
+  }
+  std::cout << (passed ? "passed" : "failed") << ", idle cpu "
+            << 1000.0 * (cpu_end - cpu_beg) / CLOCKS_PER_SEC << "ms / 200ms" << std::endl;
+}
+
+/**
+ * 按批次 push_range / pop_bulk, 输出不同批大小下每个元素的平均耗时.
+ */
+void bulk_stack_test(std::size_t batch) {
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  LockFreeStack<int, SimpleCU::Utils::ExpBackoff<>> stack{};
+
+  std::barrier b{PARA_CNT};
+  std::vector<std::jthread> js(PARA_CNT);
+
+  auto beg{std::chrono::high_resolution_clock::now()};
+  for (int i = 0; i < PUSH_PARA_CNT; i++) {
+    js[i] = std::jthread{[&stack, &b, batch, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + PUSH_PARA_CNT - 1) / PUSH_PARA_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      std::vector<int> buf{};
+      buf.reserve(batch);
+      for (std::size_t i = beg; i < end; i += batch) {
+        buf.clear();
+        for (std::size_t j = i; j < std::min(i + batch, end); j++) {
+          buf.push_back(j);
+        }
+        stack.push_range(buf.begin(), buf.end());
+      }
+    }};
+  }
+
+  for (int i = 0; i < POP_PARA_CNT; i++) {
+    js[PUSH_PARA_CNT + i] = std::jthread{[&valtag, &stack, &b, batch, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + POP_PARA_CNT - 1) / POP_PARA_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (std::size_t i = beg; i < end;) {
+        for (int res : stack.pop_bulk(std::min(batch, end - i))) {
+          i++;
+          valtag[res] = 1;
+        }
+      }
+    }};
+  }
+
+  for (int i = 0; i < PARA_CNT; i++) {
+    js[i].join();
+  }
+  auto end{std::chrono::high_resolution_clock::now()};
+
+  bool passed{stack.pop_all().empty()};
+  for (int i = 0; i < VALTAG_SCALE; i++) {
+    if (valtag[i] != 1) {
+      passed = false;
+      break;
+    }
+  }
+  std::cout << "batch " << batch << ": " << (passed ? "passed" : "failed") << ", "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(end - beg).count() / double(VALTAG_SCALE)
+            << "ns/elem" << std::endl;
+}
+
+/**
+ * `cnt` 远大于栈中元素数时只取出现有元素, 不按 `cnt` 预留空间.
+ */
+template<typename Stack>
+void pop_bulk_overshoot_test() {
+  Stack stack{};
+  for (int i = 0; i < 1000; i++) {
+    stack.push(i);
+  }
+  std::vector<int> res{stack.pop_bulk(std::numeric_limits<std::size_t>::max())};
+  bool passed{res.size() == 1000 && res.capacity() < 2000 && res.front() == 999 && res.back() == 0};
+  passed &= stack.pop_bulk(std::numeric_limits<std::size_t>::max()).empty();
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
 void normal_stack_test() {
   std::vector<int> valtag(VALTAG_SCALE, 0);
   std::stack<int> stack{};
@@ -344,11 +509,66 @@ void legacy_normal_stack_test() {
 
 int main() {
 
+  auto beg4{std::chrono::high_resolution_clock::now()};
+  lockfree_stack_test();
+  auto end4{std::chrono::high_resolution_clock::now()};
+  std::cout << end4 - beg4 << std::endl;
+
+  auto beg0{std::chrono::high_resolution_clock::now()};
+  lockfree_stack_test<LockFreeStack<int, SimpleCU::Utils::ExpBackoff<>>>();
+  auto end0{std::chrono::high_resolution_clock::now()};
+  std::cout << end0 - beg0 << std::endl;
+
+  auto beg5{std::chrono::high_resolution_clock::now()};
+  lockfree_stack_test<LockFreeStack<int, SimpleCU::Utils::ExpBackoff<>, 8>>();
+  auto end5{std::chrono::high_resolution_clock::now()};
+  std::cout << end5 - beg5 << std::endl;
+
+  auto beg8{std::chrono::high_resolution_clock::now()};
+  lockfree_stack_test<SimpleCU::TaggedStack<int>>(VALTAG_SCALE);
+  auto end8{std::chrono::high_resolution_clock::now()};
+  std::cout << end8 - beg8 << std::endl;
+
+  auto beg9{std::chrono::high_resolution_clock::now()};
+  lockfree_stack_test<SimpleCU::TaggedStack<int, SimpleCU::Utils::ExpBackoff<>>>(VALTAG_SCALE);
+  auto end9{std::chrono::high_resolution_clock::now()};
+  std::cout << end9 - beg9 << std::endl;
+
+  auto beg6{std::chrono::high_resolution_clock::now()};
+  {
+    std::pmr::synchronized_pool_resource arena{};
+    lockfree_stack_test<ArenaLockFreeStack<int>>(&arena);
+  }
+  auto end6{std::chrono::high_resolution_clock::now()};
+  std::cout << end6 - beg6 << std::endl;
+
+  auto beg7{std::chrono::high_resolution_clock::now()};
+  move_only_stack_test();
+  auto end7{std::chrono::high_resolution_clock::now()};
+  std::cout << end7 - beg7 << std::endl;
+
+  auto beg11{std::chrono::high_resolution_clock::now()};
+  thread_churn_test<LockFreeStack<int>>();
+  thread_churn_test<HazPtrLockFreeStack<int>>();
+  pop_bulk_overshoot_test<LockFreeStack<int>>();
+  pop_bulk_overshoot_test<HazPtrLockFreeStack<int>>();
+  auto end11{std::chrono::high_resolution_clock::now()};
+  std::cout << end11 - beg11 << std::endl;
+
+  auto beg10{std::chrono::high_resolution_clock::now()};
+  blocking_stack_test();
+  auto end10{std::chrono::high_resolution_clock::now()};
+  std::cout << end10 - beg10 << std::endl;
+
   auto beg2{std::chrono::high_resolution_clock::now()};
   legacy_lockfree_stack_test();
   auto end2{std::chrono::high_resolution_clock::now()};
   std::cout << end2 - beg2 << std::endl;
 
+  for (std::size_t batch = 1; batch <= 1024; batch *= 2) {
+    bulk_stack_test(batch);
+  }
+
   auto beg1{std::chrono::high_resolution_clock::now()};
   legacy_normal_stack_test();
   auto end1{std::chrono::high_resolution_clock::now()};
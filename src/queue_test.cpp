@@ -1,93 +1,40 @@
-#include "SimpleCU_HazPtr.h"
+#include "SimpleCU_BoundedQueue.h"
+#include "SimpleCU_FAAQueue.h"
+#include "SimpleCU_FlatCombining.h"
+#include "SimpleCU_LockFreeQueue.h"
+#include "SimpleCU_MPSCQueue.h"
+#include "SimpleCU_MultiQueue.h"
+#include "SimpleCU_SPSCQueue.h"
 #include <bits/stdc++.h>
 using namespace std;
 
-// NOT CONFIRMED BUGFREE
-template<typename ValType>
-class LockFreeQueue {
-private:
-  struct Node {
-    ValType val_;
-    std::atomic<Node *> next_;
-    Node() : next_{nullptr} {
-    }
-  };
-  std::atomic<Node *> head_; // sentinel
-  std::atomic<Node *> tail_;
-  SimpleCU::HazPtr::HazPtrManager<Node, 20, 1> hazptr_manager_;
-
-public:
-  LockFreeQueue() : head_{new Node{}}, tail_{head_.load()} {
-  }
-  LockFreeQueue(const LockFreeQueue &obj) = delete;
-  LockFreeQueue &operator=(const LockFreeQueue &obj) = delete;
-
-  ~LockFreeQueue() {
-    Node *cur{head_.load(std::memory_order_relaxed)};
-    while (cur) {
-      Node *next{cur->next_.load(std::memory_order_relaxed)};
-      delete cur;
-      cur = next;
-    }
-  }
+#define MAX_THREAD_CNT 256u
+#define THREAD_CNT (std::clamp(std::thread::hardware_concurrency(), 2u, MAX_THREAD_CNT)) // 至少一个 push 线程和一个 pop 线程
+#define RECLAIM_THREAD_CNT (MAX_THREAD_CNT + 1)                                             // 另加主线程
 
-  std::optional<ValType> pop() {
-    Node *old_head{head_.load(std::memory_order_relaxed)};
-    Node *old_tail{tail_.load(std::memory_order_relaxed)};
-    if (old_head == old_tail) {
-      return std::nullopt;
-    }
-    Node *old_head_next{};
-    do {
-      Node *tmp{};
-      do {
-        tmp = old_head;
-        hazptr_manager_.set_hazptr(0, old_head);
-        old_head = head_.load(std::memory_order_seq_cst);
-      } while (old_head != tmp);
-      old_head_next = old_head->next_.load();
-    } while (old_head_next && !head_.compare_exchange_weak(old_head, old_head_next, std::memory_order_seq_cst,
-                                                           std::memory_order_relaxed));
-    // acquired `old_head`
-    if (!old_head_next) {
-      hazptr_manager_.unset_hazptr(0);
-      return std::nullopt;
-    }
-    hazptr_manager_.unset_hazptr(0);
+template<typename ValType, typename Backoff = SimpleCU::Utils::NoBackoff>
+using LockFreeQueue = SimpleCU::LockFreeQueue<ValType, SimpleCU::Reclaim::QSBRPolicy<RECLAIM_THREAD_CNT>,
+                                              SimpleCU::Utils::PoolAllocator<ValType>, Backoff>;
 
-    ValType ret{std::move(old_head->val_)};
-    if (hazptr_manager_.get_retired_cnt_local() >= 2 * hazptr_manager_.get_max_hazptr_cnt_global()) {
-      if (hazptr_manager_.check_hazptr(old_head)) { // acquire
-        hazptr_manager_.retire(old_head);
-      } else {
-        delete old_head;
-      }
-    } else {
-      hazptr_manager_.retire(old_head);
-    }
-    hazptr_manager_.reclaim_local();
-    return std::make_optional(std::move(ret));
-  }
+template<typename ValType, typename Backoff = SimpleCU::Utils::NoBackoff>
+using HazPtrLockFreeQueue = SimpleCU::LockFreeQueue<ValType, SimpleCU::Reclaim::HazPtrPolicy<RECLAIM_THREAD_CNT, 2>,
+                                                    SimpleCU::Utils::PoolAllocator<ValType>, Backoff>;
 
-  void push(const ValType &val) {
-    Node *old_tail{tail_.load(std::memory_order_relaxed)};
-    Node *new_node{new Node{}}; // new empty node
-    while (!tail_.compare_exchange_weak(old_tail, new_node, std::memory_order_acq_rel, std::memory_order_relaxed)) {
-      ;
-    }
-    // acquired `old_tail`
-    old_tail->val_ = val;
-    old_tail->next_.store(new_node, std::memory_order_release);
-    return;
-  }
-};
+template<typename ValType>
+using FAAQueue = SimpleCU::FAAQueue<ValType, SimpleCU::Reclaim::QSBRPolicy<RECLAIM_THREAD_CNT>>;
+
+template<typename ValType>
+using HazPtrFAAQueue = SimpleCU::FAAQueue<ValType, SimpleCU::Reclaim::HazPtrPolicy<RECLAIM_THREAD_CNT, 1>>;
 
-#define THREAD_CNT (std::thread::hardware_concurrency())
 #define VALTAG_SCALE 10000000ul
+#define RANK_SCALE 1000000ul
+#define RANK_WINDOW 10000ul
+#define BOUNDED_CAPACITY (1ul << 16) // 线程数超过核数时, 容量太小会使每轮满 / 空都耗尽一个时间片
 
-void lockfree_queue_test() {
+template<typename Queue = LockFreeQueue<int>, typename... Args>
+void lockfree_queue_test(Args &&...args) {
   std::vector<int> valtag(VALTAG_SCALE, 0);
-  LockFreeQueue<int> queue{};
+  Queue queue{std::forward<Args>(args)...};
 
   std::barrier b{THREAD_CNT};
   std::vector<std::thread> js(THREAD_CNT);
@@ -140,6 +87,304 @@ void lockfree_queue_test() {
   std::cout << checksum << std::endl;
 }
 
+/**
+ * 元素只能移动且不可默认构造, push 与 emplace 交替使用.
+ */
+void move_only_queue_test() {
+  struct Payload {
+    std::unique_ptr<int> val_;
+    Payload(int val) : val_{std::make_unique<int>(val)} {
+    }
+  };
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  LockFreeQueue<Payload> queue{};
+
+  constexpr std::size_t PUSH_THREAD_CNT{2};
+  constexpr std::size_t POP_THREAD_CNT{2};
+  std::barrier b{PUSH_THREAD_CNT + POP_THREAD_CNT};
+  std::vector<std::thread> js(PUSH_THREAD_CNT + POP_THREAD_CNT);
+
+  for (int i = 0; i < PUSH_THREAD_CNT; i++) {
+    js[i] = std::thread{[&queue, &b, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + PUSH_THREAD_CNT - 1) / PUSH_THREAD_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (int i = beg; i < end; i++) {
+        if (i & 1) {
+          queue.push(Payload{i});
+        } else {
+          queue.emplace(i);
+        }
+      }
+    }};
+  }
+
+  for (int i = 0; i < POP_THREAD_CNT; i++) {
+    js[PUSH_THREAD_CNT + i] = std::thread{[&valtag, &queue, &b, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + POP_THREAD_CNT - 1) / POP_THREAD_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (int i = beg; i < end;) {
+        std::optional<Payload> res{queue.pop()};
+        if (res.has_value()) {
+          i++;
+          valtag[*res.value().val_] = 1;
+        }
+      }
+    }};
+  }
+
+  for (auto &j : js) {
+    j.join();
+  }
+
+  bool passed{true};
+  for (int i = 0; i < VALTAG_SCALE; i++) {
+    if (valtag[i] != 1) {
+      passed = false;
+      break;
+    }
+  }
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 定容量队列的批量接口, 每次至多 `batch` 个, 队列满 / 空时只写入 / 读出一部分.
+ */
+void bounded_bulk_queue_test(std::size_t capacity, std::size_t batch) {
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  SimpleCU::BoundedQueue<int> queue{capacity};
+
+  std::barrier b{THREAD_CNT};
+  std::vector<std::thread> js(THREAD_CNT);
+
+  std::size_t PUSH_THREAD_CNT{THREAD_CNT / 2};
+  std::size_t POP_THREAD_CNT{THREAD_CNT - PUSH_THREAD_CNT};
+
+  for (int i = 0; i < PUSH_THREAD_CNT; i++) {
+    js[i] = std::thread{[&queue, &b, PUSH_THREAD_CNT, batch, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + PUSH_THREAD_CNT - 1) / PUSH_THREAD_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      std::vector<int> buf(batch);
+      for (std::size_t i = beg; i < end;) {
+        std::size_t cnt{std::min(batch, end - i)};
+        std::iota(buf.begin(), buf.begin() + cnt, static_cast<int>(i));
+        std::size_t pushed{queue.try_push_bulk(buf.begin(), buf.begin() + cnt)};
+        if (pushed == 0) {
+          std::this_thread::yield();
+        }
+        i += pushed;
+      }
+    }};
+  }
+
+  for (int i = 0; i < POP_THREAD_CNT; i++) {
+    js[PUSH_THREAD_CNT + i] = std::thread{[&valtag, &queue, &b, POP_THREAD_CNT, batch, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + POP_THREAD_CNT - 1) / POP_THREAD_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      std::vector<int> buf(batch);
+      for (std::size_t i = beg; i < end;) {
+        std::size_t cnt{queue.try_pop_bulk(buf.begin(), std::min(batch, end - i))};
+        if (cnt == 0) {
+          std::this_thread::yield();
+        }
+        for (std::size_t j = 0; j < cnt; j++) {
+          valtag[buf[j]] = 1;
+        }
+        i += cnt;
+      }
+    }};
+  }
+
+  for (int i = 0; i < THREAD_CNT; i++) {
+    js[i].join();
+  }
+
+  bool passed{true};
+  for (int i = 0; i < VALTAG_SCALE; i++) {
+    if (valtag[i] != 1) {
+      passed = false;
+      break;
+    }
+  }
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 一个生产者和一个消费者. `batch` 为 1 时逐个 `try_push` / `try_pop`,
+ * 否则生产者以 `reserve` / `commit` 原地写入, 消费者以 `try_pop_bulk` 批量读出.
+ */
+void spsc_queue_test(std::size_t batch) {
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  SimpleCU::SPSCQueue<int> queue{BOUNDED_CAPACITY};
+
+  std::barrier b{2};
+  std::jthread producer{[&queue, &b, batch]() {
+    b.arrive_and_wait();
+    for (std::size_t i = 0; i < VALTAG_SCALE;) {
+      std::size_t cnt{};
+      if (batch == 1) {
+        cnt = queue.try_push(static_cast<int>(i)) ? 1 : 0;
+      } else {
+        std::span<int> slots{queue.reserve(std::min(batch, VALTAG_SCALE - i))};
+        std::iota(slots.begin(), slots.end(), static_cast<int>(i));
+        cnt = slots.size();
+        queue.commit(cnt);
+      }
+      if (cnt == 0) {
+        std::this_thread::yield();
+      }
+      i += cnt;
+    }
+  }};
+  std::jthread consumer{[&valtag, &queue, &b, batch]() {
+    b.arrive_and_wait();
+    std::vector<int> buf(batch);
+    for (std::size_t i = 0; i < VALTAG_SCALE;) {
+      std::size_t cnt{};
+      if (batch == 1) {
+        if (std::optional<int> res{queue.try_pop()}; res.has_value()) {
+          valtag[i] = static_cast<int>(res.value() == i);
+          cnt = 1;
+        }
+      } else {
+        cnt = queue.try_pop_bulk(buf.begin(), batch);
+        for (std::size_t j = 0; j < cnt; j++) {
+          valtag[i + j] = static_cast<int>(buf[j] == i + j);
+        }
+      }
+      if (cnt == 0) {
+        std::this_thread::yield();
+      }
+      i += cnt;
+    }
+  }};
+  producer.join();
+  consumer.join();
+
+  // 元素必须按序到达
+  bool passed{true};
+  for (int i = 0; i < VALTAG_SCALE; i++) {
+    if (valtag[i] != 1) {
+      passed = false;
+      break;
+    }
+  }
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 多个生产者, 一个消费者. 节点预先分配, 每个生产者负责一段并按序入队,
+ * 消费者检查每个生产者的元素按序到达. `batch` 为 0 时逐个 `pop`, 否则每次 `drain(batch)`.
+ */
+void mpsc_queue_test(std::size_t batch) {
+  struct Item : SimpleCU::MPSCHook {
+    int val_;
+  };
+  std::vector<Item> items(VALTAG_SCALE);
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  SimpleCU::MPSCQueue<Item> queue{};
+
+  std::size_t PUSH_THREAD_CNT{std::max(1u, THREAD_CNT - 1)};
+  std::size_t blksz{(VALTAG_SCALE + PUSH_THREAD_CNT - 1) / PUSH_THREAD_CNT};
+  std::barrier b{static_cast<std::ptrdiff_t>(PUSH_THREAD_CNT + 1)};
+  std::vector<std::jthread> js{};
+
+  for (std::size_t i = 0; i < PUSH_THREAD_CNT; i++) {
+    js.emplace_back([&items, &queue, &b, blksz, i]() {
+      b.arrive_and_wait();
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (std::size_t i = beg; i < end; i++) {
+        items[i].val_ = static_cast<int>(i);
+        queue.push(&items[i]);
+      }
+    });
+  }
+
+  std::vector<int> last(PUSH_THREAD_CNT, -1);
+  bool ordered{true};
+  auto consume{[&](Item *item) {
+    std::size_t producer{item->val_ / blksz};
+    ordered = ordered && last[producer] < item->val_;
+    last[producer] = item->val_;
+    valtag[item->val_] = 1;
+  }};
+  b.arrive_and_wait();
+  for (std::size_t cnt = 0; cnt < VALTAG_SCALE;) {
+    if (batch == 0) {
+      if (Item *item{queue.pop()}; item) {
+        consume(item);
+        cnt++;
+      }
+      continue;
+    }
+    auto chain{queue.drain(batch)};
+    for (Item *item = chain.first_; item; item = SimpleCU::MPSCQueue<Item>::next(item)) {
+      consume(item);
+    }
+    cnt += chain.cnt_;
+  }
+  js.clear();
+
+  bool passed{ordered};
+  for (int i = 0; i < VALTAG_SCALE; i++) {
+    if (valtag[i] != 1) {
+      passed = false;
+      break;
+    }
+  }
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * MultiQueue 的秩误差: 队列中保持 `RANK_WINDOW` 个元素, 每取出一个再放入一个,
+ * 秩误差为取出时队列中比它更早放入的元素个数, 以树状数组统计.
+ */
+void multiqueue_rank_test(std::size_t factor) {
+  SimpleCU::MultiQueue<int> queue{THREAD_CNT, factor};
+  std::vector<int> tree(RANK_SCALE + 1, 0);
+  auto add{[&tree](std::size_t i, int delta) {
+    for (i++; i <= RANK_SCALE; i += i & -i) {
+      tree[i] += delta;
+    }
+  }};
+  auto count_before{[&tree](std::size_t i) {
+    std::size_t cnt{};
+    for (; i > 0; i -= i & -i) {
+      cnt += tree[i];
+    }
+    return cnt;
+  }};
+
+  std::size_t next{};
+  for (; next < RANK_WINDOW; next++) {
+    queue.push(static_cast<int>(next));
+    add(next, 1);
+  }
+  std::size_t sum{}, max{};
+  for (std::size_t i = 0; i < RANK_SCALE; i++) {
+    std::size_t val{static_cast<std::size_t>(queue.pop().value())};
+    std::size_t rank{count_before(val)};
+    add(val, -1);
+    sum += rank;
+    max = std::max(max, rank);
+    if (next < RANK_SCALE) {
+      queue.push(static_cast<int>(next));
+      add(next, 1);
+      next++;
+    }
+  }
+  std::cout << "shards " << queue.shard_cnt() << " mean rank error " << static_cast<double>(sum) / RANK_SCALE
+            << " max " << max << std::endl;
+}
+
 void normal_queue_test() {
   std::vector<int> valtag(VALTAG_SCALE, 0);
   // LockFreeQueue<int> queue{};
@@ -202,11 +447,79 @@ void normal_queue_test() {
 
 int main() {
 
+  auto beg3{std::chrono::high_resolution_clock::now()};
+  move_only_queue_test();
+  auto end3{std::chrono::high_resolution_clock::now()};
+  std::cout << end3 - beg3 << std::endl;
+
+  auto beg0{std::chrono::high_resolution_clock::now()};
+  lockfree_queue_test<LockFreeQueue<int, SimpleCU::Utils::ExpBackoff<>>>();
+  auto end0{std::chrono::high_resolution_clock::now()};
+  std::cout << end0 - beg0 << std::endl;
+
+  auto beg5{std::chrono::high_resolution_clock::now()};
+  lockfree_queue_test<HazPtrLockFreeQueue<int>>();
+  auto end5{std::chrono::high_resolution_clock::now()};
+  std::cout << end5 - beg5 << std::endl;
+
   auto beg1{std::chrono::high_resolution_clock::now()};
   lockfree_queue_test();
   auto end1{std::chrono::high_resolution_clock::now()};
   std::cout << end1 - beg1 << std::endl;
 
+  auto beg10{std::chrono::high_resolution_clock::now()};
+  lockfree_queue_test<FAAQueue<int>>();
+  auto end10{std::chrono::high_resolution_clock::now()};
+  std::cout << end10 - beg10 << std::endl;
+
+  auto beg11{std::chrono::high_resolution_clock::now()};
+  lockfree_queue_test<HazPtrFAAQueue<int>>();
+  auto end11{std::chrono::high_resolution_clock::now()};
+  std::cout << end11 - beg11 << std::endl;
+
+  auto beg6{std::chrono::high_resolution_clock::now()};
+  lockfree_queue_test<SimpleCU::BoundedQueue<int>>(BOUNDED_CAPACITY);
+  auto end6{std::chrono::high_resolution_clock::now()};
+  std::cout << end6 - beg6 << std::endl;
+
+  auto beg7{std::chrono::high_resolution_clock::now()};
+  bounded_bulk_queue_test(BOUNDED_CAPACITY, 32);
+  auto end7{std::chrono::high_resolution_clock::now()};
+  std::cout << end7 - beg7 << std::endl;
+
+  auto beg8{std::chrono::high_resolution_clock::now()};
+  spsc_queue_test(1);
+  auto end8{std::chrono::high_resolution_clock::now()};
+  std::cout << end8 - beg8 << std::endl;
+
+  auto beg9{std::chrono::high_resolution_clock::now()};
+  spsc_queue_test(64);
+  auto end9{std::chrono::high_resolution_clock::now()};
+  std::cout << end9 - beg9 << std::endl;
+
+  auto beg12{std::chrono::high_resolution_clock::now()};
+  mpsc_queue_test(0);
+  auto end12{std::chrono::high_resolution_clock::now()};
+  std::cout << end12 - beg12 << std::endl;
+
+  auto beg13{std::chrono::high_resolution_clock::now()};
+  mpsc_queue_test(64);
+  auto end13{std::chrono::high_resolution_clock::now()};
+  std::cout << end13 - beg13 << std::endl;
+
+  for (std::size_t factor : {1ul, 2ul, 4ul, 8ul}) {
+    multiqueue_rank_test(factor);
+    auto beg14{std::chrono::high_resolution_clock::now()};
+    lockfree_queue_test<SimpleCU::MultiQueue<int>>(THREAD_CNT, factor);
+    auto end14{std::chrono::high_resolution_clock::now()};
+    std::cout << end14 - beg14 << std::endl;
+  }
+
+  auto beg4{std::chrono::high_resolution_clock::now()};
+  lockfree_queue_test<SimpleCU::FCQueue<int>>();
+  auto end4{std::chrono::high_resolution_clock::now()};
+  std::cout << end4 - beg4 << std::endl;
+
   auto beg2{std::chrono::high_resolution_clock::now()};
   normal_queue_test();
   auto end2{std::chrono::high_resolution_clock::now()};
@@ -0,0 +1,200 @@
+#include "SimpleCU_ShmQueue.h"
+#include <bits/stdc++.h>
+#include <sys/wait.h>
+
+#define THREAD_CNT (std::max(2u, std::thread::hardware_concurrency()))
+#define PROC_CNT 4u
+#define VALTAG_SCALE 4000000ul
+#define SPSC_SCALE 10000000ul
+#define CRASH_PUSH_CNT 100ul
+#define SHM_CAPACITY 1024ul
+
+using ShmQueue = SimpleCU::ShmQueue<std::size_t>;
+
+/**
+ * 在子进程中以 `attach` 得到的队列执行 `fn`, 之后 `_exit`, 不运行父进程的析构.
+ */
+template<typename Fn>
+auto spawn(int fd, Fn &&fn) -> pid_t {
+  pid_t pid{::fork()};
+  if (pid == 0) {
+    std::optional<ShmQueue> queue{ShmQueue::attach(fd)};
+    if (queue.has_value()) {
+      std::forward<Fn>(fn)(queue.value());
+    }
+    ::_exit(queue.has_value() ? 0 : 1);
+  }
+  return pid;
+}
+
+auto wait_child(pid_t pid) -> bool {
+  int status{};
+  return ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * `PROC_CNT` 个子进程各自入队一段值, 父进程的多个线程出队, 每个值恰好取出一次.
+ */
+void mpmc_process_test() {
+  std::optional<ShmQueue> queue{ShmQueue::create("mpmc_process_test", SHM_CAPACITY)};
+  if (!queue.has_value()) {
+    std::cout << "failed" << std::endl;
+    return;
+  }
+  // 先 fork 再创建线程
+  std::vector<pid_t> children(PROC_CNT);
+  for (std::size_t i = 0; i < PROC_CNT; i++) {
+    children[i] = spawn(queue->fd(), [i](ShmQueue &q) {
+      auto ep{q.endpoint()};
+      std::size_t blksz{(VALTAG_SCALE + PROC_CNT - 1) / PROC_CNT};
+      for (std::size_t j = blksz * i; j < std::min(blksz * (i + 1), VALTAG_SCALE); j++) {
+        ep->push(j);
+      }
+    });
+  }
+
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  std::size_t thread_cnt{THREAD_CNT};
+  std::vector<std::jthread> js(thread_cnt);
+  for (std::size_t i = 0; i < thread_cnt; i++) {
+    js[i] = std::jthread{[&queue, &valtag, thread_cnt, i]() {
+      auto ep{queue->endpoint()};
+      std::size_t blksz{(VALTAG_SCALE + thread_cnt - 1) / thread_cnt};
+      for (std::size_t j = blksz * i; j < std::min(blksz * (i + 1), VALTAG_SCALE); j++) {
+        valtag[ep->pop()]++;
+      }
+    }};
+  }
+  js.clear();
+
+  bool passed{std::ranges::all_of(children, wait_child)};
+  passed &= std::ranges::all_of(valtag, [](int v) { return v == 1; }) && !queue->endpoint()->try_pop().has_value();
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 子进程分别在写入元素中途和读取元素中途崩溃, `recover` 之后队列应能继续使用:
+ * 写入中途的元素被跳过, 读取中途的元素丢失, 其余元素按序取出.
+ */
+void crash_test() {
+  std::optional<ShmQueue> queue{ShmQueue::create("crash_test", SHM_CAPACITY)};
+  if (!queue.has_value()) {
+    std::cout << "failed" << std::endl;
+    return;
+  }
+  bool passed{true};
+
+  pid_t producer{spawn(queue->fd(), [](ShmQueue &q) {
+    auto ep{q.endpoint()};
+    for (std::size_t i = 0; i < CRASH_PUSH_CNT; i++) {
+      ep->push(i);
+    }
+    ep->try_push_with([](std::size_t &slot) {
+      slot = CRASH_PUSH_CNT;
+      ::_exit(0);
+    });
+  })};
+  passed &= wait_child(producer);
+
+  auto ep{queue->endpoint()};
+  ep->push(CRASH_PUSH_CNT + 1);                  // 排在作废的槽位之后, recover 之前取不到
+  passed &= ep->try_pop() == 0;                  // 作废槽位之前的元素不受影响
+  passed &= queue->recover() == 1;
+
+  pid_t consumer{spawn(queue->fd(), [](ShmQueue &q) {
+    auto ep{q.endpoint()};
+    ep->try_pop_with([](const std::size_t &) { ::_exit(0); });
+  })};
+  passed &= wait_child(consumer);
+  passed &= queue->recover() == 1;
+
+  // 1 已被崩溃的消费者取走, 作废的槽位被跳过
+  std::vector<std::size_t> rest{};
+  while (auto res{ep->try_pop()}) {
+    rest.push_back(res.value());
+  }
+  std::vector<std::size_t> expected{};
+  for (std::size_t i = 2; i < CRASH_PUSH_CNT; i++) {
+    expected.push_back(i);
+  }
+  expected.push_back(CRASH_PUSH_CNT + 1);
+  passed &= rest == expected;
+
+  // 回收后容量完整可用
+  for (std::size_t i = 0; i < queue->capacity(); i++) {
+    passed &= ep->try_push(i);
+  }
+  passed &= !ep->try_push(0);
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 子进程在空队列上睡眠时被杀死, `recover` 之后不应残留等待者, 否则之后每次入队 / 出队都会进入内核.
+ */
+void crash_while_waiting_test() {
+  std::optional<ShmQueue> queue{ShmQueue::create("crash_while_waiting_test", SHM_CAPACITY)};
+  if (!queue.has_value()) {
+    std::cout << "failed" << std::endl;
+    return;
+  }
+  pid_t consumer{spawn(queue->fd(), [](ShmQueue &q) { q.endpoint()->pop(); })};
+  auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{5}};
+  while (queue->waiter_cnt() == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  bool passed{queue->waiter_cnt() == 1};
+  ::kill(consumer, SIGKILL);
+  ::waitpid(consumer, nullptr, 0);
+  passed &= queue->recover() == 1 && queue->waiter_cnt() == 0;
+
+  auto ep{queue->endpoint()};
+  ep->push(1);
+  passed &= ep->pop() == 1 && queue->waiter_cnt() == 0;
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 一个子进程入队, 父进程出队, 顺序应与入队一致.
+ */
+void spsc_process_test() {
+  std::optional<ShmQueue> queue{ShmQueue::create("spsc_process_test", SHM_CAPACITY)};
+  if (!queue.has_value()) {
+    std::cout << "failed" << std::endl;
+    return;
+  }
+  pid_t producer{spawn(queue->fd(), [](ShmQueue &q) {
+    auto ep{q.endpoint()};
+    for (std::size_t i = 0; i < SPSC_SCALE; i++) {
+      ep->push(i);
+    }
+  })};
+  auto ep{queue->endpoint()};
+  bool passed{true};
+  for (std::size_t i = 0; i < SPSC_SCALE; i++) {
+    passed &= ep->pop() == i;
+  }
+  passed &= wait_child(producer);
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+int main() {
+  auto beg0{std::chrono::high_resolution_clock::now()};
+  mpmc_process_test();
+  auto end0{std::chrono::high_resolution_clock::now()};
+  std::cout << end0 - beg0 << std::endl;
+
+  auto beg1{std::chrono::high_resolution_clock::now()};
+  crash_test();
+  auto end1{std::chrono::high_resolution_clock::now()};
+  std::cout << end1 - beg1 << std::endl;
+
+  auto beg2{std::chrono::high_resolution_clock::now()};
+  crash_while_waiting_test();
+  auto end2{std::chrono::high_resolution_clock::now()};
+  std::cout << end2 - beg2 << std::endl;
+
+  auto beg3{std::chrono::high_resolution_clock::now()};
+  spsc_process_test();
+  auto end3{std::chrono::high_resolution_clock::now()};
+  std::cout << end3 - beg3 << std::endl;
+}
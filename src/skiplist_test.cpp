@@ -0,0 +1,258 @@
+#include "SimpleCU_SkipListMap.h"
+#include "SimpleCU_SkipListPQ.h"
+#include <bits/stdc++.h>
+
+#define MAX_THREAD_CNT 256u
+#define THREAD_CNT (std::clamp(std::thread::hardware_concurrency(), 2u, MAX_THREAD_CNT)) // 至少一个 push 线程和一个 pop 线程
+#define VALTAG_SCALE 2000000ul
+#define ORDER_SCALE 200000ul
+#define MAP_SCALE 200000ul
+#define HOT_KEY_CNT 64u
+
+using Reclaimer = SimpleCU::Reclaim::QSBRPolicy<MAX_THREAD_CNT + 2>; // 另加扫描线程和主线程
+
+template<typename Key, typename ValType>
+using SkipListPQ = SimpleCU::SkipListPQ<Key, ValType, std::less<Key>, Reclaimer>;
+
+template<typename Key, typename ValType>
+using SkipListMap = SimpleCU::SkipListMap<Key, ValType, std::less<Key>, Reclaimer>;
+
+/**
+ * 以互斥锁保护的 `std::priority_queue`, 作为对照.
+ */
+template<typename Key, typename ValType>
+class MutexPQ {
+private:
+  using Entry_ = std::pair<Key, ValType>;
+
+  std::mutex mtx_;
+  std::priority_queue<Entry_, std::vector<Entry_>, std::greater<Entry_>> pq_;
+
+public:
+  void push(Key key, ValType val) {
+    std::lock_guard lock{mtx_};
+    pq_.emplace(std::move(key), std::move(val));
+  }
+
+  auto pop() -> std::optional<Entry_> {
+    std::lock_guard lock{mtx_};
+    if (pq_.empty()) {
+      return std::nullopt;
+    }
+    std::optional<Entry_> ret{pq_.top()};
+    pq_.pop();
+    return ret;
+  }
+};
+
+/**
+ * 单线程随机键入队后全部取出, 键应单调不减.
+ */
+void pq_order_test() {
+  SkipListPQ<std::uint32_t, std::size_t> pq{};
+  for (std::size_t i = 0; i < ORDER_SCALE; i++) {
+    pq.push(SimpleCU::Utils::fast_random() % (ORDER_SCALE / 4), i);
+  }
+  bool passed{true};
+  std::size_t cnt{};
+  std::uint32_t prev{};
+  while (auto res{pq.pop()}) {
+    if (res->first < prev) {
+      passed = false;
+    }
+    prev = res->first;
+    cnt++;
+  }
+  std::cout << (passed && cnt == ORDER_SCALE ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 一半线程以随机键入队, 另一半取出, 每个元素恰好取出一次.
+ */
+template<typename PQ>
+void pq_concurrent_test() {
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  PQ pq{};
+  std::size_t thread_cnt{THREAD_CNT};
+  std::size_t push_thread_cnt{thread_cnt / 2};
+  std::size_t pop_thread_cnt{thread_cnt - push_thread_cnt};
+
+  std::barrier b{THREAD_CNT};
+  std::vector<std::jthread> js(thread_cnt);
+  for (std::size_t i = 0; i < push_thread_cnt; i++) {
+    js[i] = std::jthread{[&pq, &b, push_thread_cnt, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + push_thread_cnt - 1) / push_thread_cnt};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (std::size_t j = beg; j < end; j++) {
+        pq.push(SimpleCU::Utils::fast_random(), j);
+      }
+    }};
+  }
+  for (std::size_t i = 0; i < pop_thread_cnt; i++) {
+    js[push_thread_cnt + i] = std::jthread{[&valtag, &pq, &b, pop_thread_cnt, i]() {
+      b.arrive_and_wait();
+      std::size_t blksz{(VALTAG_SCALE + pop_thread_cnt - 1) / pop_thread_cnt};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, VALTAG_SCALE)};
+      for (std::size_t j = beg; j < end;) {
+        if (auto res{pq.pop()}; res.has_value()) {
+          valtag[res->second]++;
+          j++;
+        }
+      }
+    }};
+  }
+  js.clear();
+
+  bool passed{std::ranges::all_of(valtag, [](int v) { return v == 1; }) && !pq.pop().has_value()};
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 单线程随机插入 / 删除, 与 `std::map` 对照 `find`, `lower_bound`, `range`.
+ */
+void map_basic_test() {
+  SkipListMap<std::uint32_t, std::uint32_t> map{};
+  std::map<std::uint32_t, std::uint32_t> ref{};
+  bool passed{true};
+  for (std::size_t i = 0; i < MAP_SCALE; i++) {
+    std::uint32_t key{static_cast<std::uint32_t>(SimpleCU::Utils::fast_random() % (MAP_SCALE / 2))};
+    if (i % 3 == 2) {
+      passed &= map.erase(key) == (ref.erase(key) == 1);
+    } else {
+      passed &= map.insert(key, key * 2) == ref.emplace(key, key * 2).second;
+    }
+  }
+  for (std::uint32_t key = 0; key < MAP_SCALE / 2; key += 7) {
+    auto iter{ref.find(key)};
+    passed &= map.find(key) == (iter == ref.end() ? std::nullopt : std::make_optional(iter->second));
+  }
+  passed &= std::ranges::equal(map.all(), ref);
+  passed &= std::ranges::equal(map.lower_bound(MAP_SCALE / 4),
+                               std::ranges::subrange(ref.lower_bound(MAP_SCALE / 4), ref.end()));
+  passed &= std::ranges::equal(map.range(MAP_SCALE / 8, MAP_SCALE / 4),
+                               std::ranges::subrange(ref.lower_bound(MAP_SCALE / 8), ref.lower_bound(MAP_SCALE / 4)));
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 每个写线程在各自的键上随机插入 / 删除并记录, 扫描线程同时反复遍历, 遍历中嵌套 `find`.
+ * 扫描到的键应严格递增, 结束时 map 的内容应等于各线程记录的并集.
+ */
+void map_concurrent_test() {
+  SkipListMap<std::uint32_t, std::uint32_t> map{};
+  std::size_t writer_cnt{THREAD_CNT};
+  std::vector<std::set<std::uint32_t>> shadows(writer_cnt);
+  std::atomic<bool> done{};
+  std::atomic<bool> ops_passed{true};
+
+  std::barrier b{THREAD_CNT + 1};
+  std::vector<std::jthread> js(writer_cnt);
+  for (std::size_t i = 0; i < writer_cnt; i++) {
+    js[i] = std::jthread{[&map, &shadows, &ops_passed, &b, writer_cnt, i]() {
+      b.arrive_and_wait();
+      std::set<std::uint32_t> &shadow{shadows[i]};
+      bool passed{true};
+      for (std::size_t j = 0; j < MAP_SCALE; j++) {
+        auto key{static_cast<std::uint32_t>(SimpleCU::Utils::fast_random() % (MAP_SCALE / 4) * writer_cnt + i)};
+        if (j % 3 == 2) {
+          passed &= map.erase(key) == (shadow.erase(key) == 1);
+        } else {
+          passed &= map.insert(key, key) == shadow.insert(key).second;
+        }
+      }
+      if (!passed) {
+        ops_passed.store(false, std::memory_order_relaxed);
+      }
+    }};
+  }
+  std::jthread scanner{[&map, &done, &ops_passed, &b]() {
+    b.arrive_and_wait();
+    while (!done.load(std::memory_order_acquire)) {
+      std::optional<std::uint32_t> prev{};
+      for (const auto &[key, val] : map.all()) {
+        std::optional<std::uint32_t> res{map.find(key)}; // 遍历到之后可能已被删除
+        if ((prev.has_value() && key <= prev.value()) || key != val || (res.has_value() && res.value() != key)) {
+          ops_passed.store(false, std::memory_order_relaxed);
+        }
+        prev = key;
+      }
+    }
+  }};
+  js.clear();
+  done.store(true, std::memory_order_release);
+  scanner.join();
+
+  std::set<std::uint32_t> expected{};
+  for (auto &shadow : shadows) {
+    expected.merge(shadow);
+  }
+  auto all{map.all()};
+  bool passed{ops_passed.load() && std::ranges::equal(all | std::views::keys, expected)};
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 所有线程在少量键上竞争插入 / 删除. 每个键成功插入次数减成功删除次数应为 0 或 1, 且与最终是否存在一致.
+ */
+void map_hot_key_test() {
+  SkipListMap<std::uint32_t, std::uint32_t> map{};
+  std::vector<std::atomic<int>> net(HOT_KEY_CNT);
+
+  std::barrier b{THREAD_CNT};
+  std::vector<std::jthread> js(THREAD_CNT);
+  for (auto &j : js) {
+    j = std::jthread{[&map, &net, &b]() {
+      b.arrive_and_wait();
+      for (std::size_t i = 0; i < MAP_SCALE; i++) {
+        std::uint32_t key{SimpleCU::Utils::fast_random() % HOT_KEY_CNT};
+        if (i & 1) {
+          net[key].fetch_sub(map.erase(key), std::memory_order_relaxed);
+        } else {
+          net[key].fetch_add(map.insert(key, key), std::memory_order_relaxed);
+        }
+      }
+    }};
+  }
+  js.clear();
+
+  bool passed{true};
+  for (std::uint32_t key = 0; key < HOT_KEY_CNT; key++) {
+    passed &= net[key].load() == static_cast<int>(map.contains(key));
+  }
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+int main() {
+  auto beg0{std::chrono::high_resolution_clock::now()};
+  pq_order_test();
+  auto end0{std::chrono::high_resolution_clock::now()};
+  std::cout << end0 - beg0 << std::endl;
+
+  auto beg1{std::chrono::high_resolution_clock::now()};
+  pq_concurrent_test<SkipListPQ<std::uint32_t, std::size_t>>();
+  auto end1{std::chrono::high_resolution_clock::now()};
+  std::cout << end1 - beg1 << std::endl;
+
+  auto beg2{std::chrono::high_resolution_clock::now()};
+  pq_concurrent_test<MutexPQ<std::uint32_t, std::size_t>>();
+  auto end2{std::chrono::high_resolution_clock::now()};
+  std::cout << end2 - beg2 << std::endl;
+
+  auto beg3{std::chrono::high_resolution_clock::now()};
+  map_basic_test();
+  auto end3{std::chrono::high_resolution_clock::now()};
+  std::cout << end3 - beg3 << std::endl;
+
+  auto beg4{std::chrono::high_resolution_clock::now()};
+  map_concurrent_test();
+  auto end4{std::chrono::high_resolution_clock::now()};
+  std::cout << end4 - beg4 << std::endl;
+
+  auto beg5{std::chrono::high_resolution_clock::now()};
+  map_hot_key_test();
+  auto end5{std::chrono::high_resolution_clock::now()};
+  std::cout << end5 - beg5 << std::endl;
+}
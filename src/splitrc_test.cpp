@@ -0,0 +1,92 @@
+#include "SimpleCU_SplitRC.h"
+#include <bits/stdc++.h>
+
+#define PARA_CNT (20)
+#define READ_SCALE 1000000ul
+#define WRITE_SCALE 100000ul
+
+std::atomic<std::int64_t> live_cnt{};
+
+struct Config {
+  std::uint64_t version_;
+  std::array<std::uint64_t, 8> payload_;
+
+  Config(std::uint64_t version) : version_{version} {
+    payload_.fill(version);
+    live_cnt.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~Config() {
+    payload_.fill(0);
+    live_cnt.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  auto consistent() const -> bool {
+    return std::all_of(payload_.begin(), payload_.end(), [this](std::uint64_t v) { return v == version_; });
+  }
+};
+
+/**
+ * 1 个线程不断 store 新配置, 其余线程 load 并检查读到的配置未被提前析构.
+ */
+template<typename AtomicPtr, typename MakeFunc>
+void shared_ptr_test(MakeFunc &&make) {
+  bool passed{true};
+  {
+    AtomicPtr config{make(0)};
+    std::atomic<bool> broken{};
+
+    std::barrier b{PARA_CNT};
+    std::vector<std::jthread> js(PARA_CNT);
+
+    js[0] = std::jthread{[&config, &b, &make]() {
+      b.arrive_and_wait();
+      for (std::uint64_t i = 1; i <= WRITE_SCALE; i++) {
+        config.store(make(i));
+      }
+    }};
+
+    for (int i = 1; i < PARA_CNT; i++) {
+      js[i] = std::jthread{[&config, &b, &broken]() {
+        b.arrive_and_wait();
+        std::uint64_t last_version{};
+        for (std::size_t j = 0; j < READ_SCALE; j++) {
+          auto cur{config.load()};
+          if (!cur->consistent() || cur->version_ < last_version) {
+            broken.store(true, std::memory_order_relaxed);
+          }
+          last_version = cur->version_;
+        }
+      }};
+    }
+
+    for (int i = 0; i < PARA_CNT; i++) {
+      js[i].join();
+    }
+    passed = !broken.load() && live_cnt.load() == 1;
+  }
+  passed = passed && live_cnt.load() == 0;
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+void splitrc_test() {
+  using SimpleCU::SplitRC::AtomicSharedPtr;
+  shared_ptr_test<AtomicSharedPtr<Config>>(
+      [](std::uint64_t v) { return SimpleCU::SplitRC::make_shared<Config>(v); });
+}
+
+void std_atomic_shared_ptr_test() {
+  shared_ptr_test<std::atomic<std::shared_ptr<Config>>>([](std::uint64_t v) { return std::make_shared<Config>(v); });
+}
+
+int main() {
+
+  auto beg1{std::chrono::high_resolution_clock::now()};
+  splitrc_test();
+  auto end1{std::chrono::high_resolution_clock::now()};
+  std::cout << end1 - beg1 << std::endl;
+
+  auto beg2{std::chrono::high_resolution_clock::now()};
+  std_atomic_shared_ptr_test();
+  auto end2{std::chrono::high_resolution_clock::now()};
+  std::cout << end2 - beg2 << std::endl;
+}
@@ -0,0 +1,225 @@
+#include "SimpleCU_ChaseLevDeque.h"
+#include "SimpleCU_ThreadPool.h"
+#include <bits/stdc++.h>
+
+#define PARA_CNT (std::max(4u, std::thread::hardware_concurrency()))
+#define VALTAG_SCALE 5000000ul
+#define STEAL_SCALE 2000000ul
+#define SKEW_SCALE 4096ul
+
+/**
+ * 所有者交替 push / take, 其余线程不停窃取. 初始容量为 2, 过程中反复扩容.
+ */
+void chase_lev_test() {
+  std::vector<std::atomic<int>> valtag(STEAL_SCALE);
+  SimpleCU::ChaseLevDeque<std::size_t> deque{2};
+  std::atomic<bool> done{};
+
+  std::barrier b{PARA_CNT};
+  std::vector<std::jthread> js{};
+  for (std::size_t i = 1; i < PARA_CNT; i++) {
+    js.emplace_back([&valtag, &deque, &done, &b]() {
+      b.arrive_and_wait();
+      while (!done.load(std::memory_order_acquire)) {
+        if (std::optional<std::size_t> res{deque.steal()}; res.has_value()) {
+          valtag[res.value()].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+
+  b.arrive_and_wait();
+  for (std::size_t i = 0; i < STEAL_SCALE; i++) {
+    deque.push(i);
+    if (i % 3 == 0) {
+      if (std::optional<std::size_t> res{deque.take()}; res.has_value()) {
+        valtag[res.value()].fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  while (std::optional<std::size_t> res{deque.take()}) {
+    valtag[res.value()].fetch_add(1, std::memory_order_relaxed);
+  }
+  done.store(true, std::memory_order_release);
+  js.clear();
+
+  bool passed{true};
+  for (std::size_t i = 0; i < STEAL_SCALE; i++) {
+    if (valtag[i].load(std::memory_order_relaxed) != 1) {
+      passed = false;
+      break;
+    }
+  }
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+void parallel_for_test(SimpleCU::ThreadPool &pool) {
+  std::vector<int> valtag(VALTAG_SCALE, 0);
+  pool.parallel_for(0ul, VALTAG_SCALE, [&valtag](std::size_t i) { valtag[i]++; });
+
+  bool passed{std::ranges::all_of(valtag, [](int v) { return v == 1; })};
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 前 1/8 的下标代价是其余的 64 倍. 静态分块时第一个线程拖慢整体, 线程池由窃取平衡.
+ */
+auto skewed_work(std::size_t i) -> std::uint64_t {
+  std::uint64_t rounds{i < SKEW_SCALE / 8 ? 64ul * 1024 : 1024ul};
+  std::uint64_t x{i};
+  for (std::uint64_t r = 0; r < rounds; r++) {
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+  }
+  return x;
+}
+
+/**
+ * 单线程计算的校验和, 作为两种分块方式的参照.
+ */
+auto skewed_checksum() -> std::uint64_t {
+  std::uint64_t sum{};
+  for (std::size_t i = 0; i < SKEW_SCALE; i++) {
+    sum += skewed_work(i);
+  }
+  return sum;
+}
+
+void skewed_static_test(std::uint64_t expected) {
+  std::vector<std::uint64_t> res(SKEW_SCALE);
+  std::vector<std::jthread> js(PARA_CNT);
+  for (std::size_t i = 0; i < PARA_CNT; i++) {
+    js[i] = std::jthread{[&res, i]() {
+      std::size_t blksz{(SKEW_SCALE + PARA_CNT - 1) / PARA_CNT};
+      std::size_t beg{blksz * i};
+      std::size_t end{std::min(beg + blksz, SKEW_SCALE)};
+      for (std::size_t j = beg; j < end; j++) {
+        res[j] = skewed_work(j);
+      }
+    }};
+  }
+  js.clear();
+  std::cout << (std::accumulate(res.begin(), res.end(), 0ull) == expected ? "passed" : "failed") << std::endl;
+}
+
+void skewed_pool_test(SimpleCU::ThreadPool &pool, std::uint64_t expected) {
+  std::vector<std::uint64_t> res(SKEW_SCALE);
+  pool.parallel_for(0ul, SKEW_SCALE, [&res](std::size_t i) { res[i] = skewed_work(i); }, 16);
+  std::cout << (std::accumulate(res.begin(), res.end(), 0ull) == expected ? "passed" : "failed") << std::endl;
+}
+
+auto fib(SimpleCU::ThreadPool &pool, std::uint32_t n) -> std::uint64_t {
+  if (n < 16) {
+    return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+  }
+  std::uint64_t x{}, y{};
+  SimpleCU::TaskGroup group{pool};
+  group.run([&pool, &x, n]() { x = fib(pool, n - 1); });
+  y = fib(pool, n - 2);
+  group.wait();
+  return x + y;
+}
+
+/**
+ * 任务内嵌套 `TaskGroup` 并在工作线程上等待.
+ */
+void task_group_test(SimpleCU::ThreadPool &pool) {
+  std::uint64_t res{};
+  SimpleCU::TaskGroup group{pool};
+  group.run([&pool, &res]() { res = fib(pool, 30); });
+  group.wait();
+  std::cout << (res == 832040 ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 多个外部线程同时提交, 任务经注入队列进入线程池.
+ */
+void submit_test(SimpleCU::ThreadPool &pool) {
+  std::atomic<std::size_t> cnt{};
+  std::barrier b{PARA_CNT};
+  std::vector<std::jthread> js(PARA_CNT);
+  for (std::size_t i = 0; i < PARA_CNT; i++) {
+    js[i] = std::jthread{[&pool, &cnt, &b]() {
+      SimpleCU::TaskGroup group{pool};
+      std::size_t task_cnt{VALTAG_SCALE / PARA_CNT};
+      b.arrive_and_wait();
+      for (std::size_t j = 0; j < task_cnt; j++) {
+        group.run([&cnt]() { cnt.fetch_add(1, std::memory_order_relaxed); });
+      }
+      group.wait();
+    }};
+  }
+  js.clear();
+  std::cout << (cnt.load() == VALTAG_SCALE / PARA_CNT * PARA_CNT ? "passed" : "failed") << std::endl;
+}
+
+/**
+ * 两个工作线程, 第一个任务占住一个工作线程直到其余任务全部完成 (至多 1s).
+ * 它开始执行后才提交的任务不能停留在忙碌的工作线程处, 应全部由另一个工作线程执行.
+ */
+void busy_worker_test() {
+  SimpleCU::ThreadPool pool{2};
+  std::atomic<std::size_t> cnt{};
+  std::atomic<bool> started{};
+  std::atomic<bool> released{};
+  pool.submit([&started, &released]() {
+    started.store(true, std::memory_order_release);
+    auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{1}};
+    while (!released.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+  });
+  while (!started.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+  for (std::size_t i = 0; i < 8; i++) {
+    pool.submit([&cnt]() { cnt.fetch_add(1, std::memory_order_release); });
+  }
+  auto deadline{std::chrono::steady_clock::now() + std::chrono::milliseconds{500}};
+  while (cnt.load(std::memory_order_acquire) < 8 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  bool passed{cnt.load(std::memory_order_acquire) == 8};
+  released.store(true, std::memory_order_release);
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+}
+
+int main() {
+  auto beg0{std::chrono::high_resolution_clock::now()};
+  chase_lev_test();
+  auto end0{std::chrono::high_resolution_clock::now()};
+  std::cout << end0 - beg0 << std::endl;
+
+  SimpleCU::ThreadPool pool{PARA_CNT};
+
+  auto beg1{std::chrono::high_resolution_clock::now()};
+  parallel_for_test(pool);
+  auto end1{std::chrono::high_resolution_clock::now()};
+  std::cout << end1 - beg1 << std::endl;
+
+  std::uint64_t skewed_expected{skewed_checksum()};
+
+  auto beg2{std::chrono::high_resolution_clock::now()};
+  skewed_static_test(skewed_expected);
+  auto end2{std::chrono::high_resolution_clock::now()};
+  std::cout << end2 - beg2 << std::endl;
+
+  auto beg3{std::chrono::high_resolution_clock::now()};
+  skewed_pool_test(pool, skewed_expected);
+  auto end3{std::chrono::high_resolution_clock::now()};
+  std::cout << end3 - beg3 << std::endl;
+
+  auto beg4{std::chrono::high_resolution_clock::now()};
+  task_group_test(pool);
+  auto end4{std::chrono::high_resolution_clock::now()};
+  std::cout << end4 - beg4 << std::endl;
+
+  auto beg5{std::chrono::high_resolution_clock::now()};
+  submit_test(pool);
+  auto end5{std::chrono::high_resolution_clock::now()};
+  std::cout << end5 - beg5 << std::endl;
+
+  auto beg6{std::chrono::high_resolution_clock::now()};
+  busy_worker_test();
+  auto end6{std::chrono::high_resolution_clock::now()};
+  std::cout << end6 - beg6 << std::endl;
+}